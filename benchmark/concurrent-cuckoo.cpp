@@ -0,0 +1,100 @@
+#include <vector>
+#include <string>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <numeric>
+#include <fstream>
+
+#include "benchmark.hpp"
+#include "cuckoo-hash/cuckoo-hash.hpp"
+#include "cuckoo-hash/concurrent-cuckoo-hash.hpp"
+
+// These tests are timed one at a time instead of with a BenchmarkSuite. The
+// suite runs its tests on parallel threads, which would hide how each map
+// scales with the number of reader threads.
+namespace concurrent {
+
+// Keeps the compiler from optimizing away lookups whose result is unused
+std::atomic<size_t> sink;
+
+// CuckooHashMap shared behind a reader-writer lock, the way it has to be shared today.
+class MutexCuckooHashMap {
+    CuckooHashMap<int, int> map_;
+    mutable std::shared_mutex mutex_;
+
+  public:
+    bool contains(int key) const {
+        std::shared_lock lock(mutex_);
+        return map_.contains(key);
+    }
+    void insert(int key, int value){
+        std::unique_lock lock(mutex_);
+        map_.insert(key, value);
+    }
+};
+
+// numReaders threads each look up n random keys while one writer inserts new
+// keys. map must already hold the keys 0 to n - 1.
+template <typename map_t>
+void readMostly(map_t &map, size_t n, size_t numReaders){
+    std::vector<std::thread> threads;
+    threads.emplace_back([&map, n](){
+        for (size_t i = n; i < n + n / 10; ++i){
+            map.insert(int(i), int(i));
+        }
+    });
+    for (size_t r = 0; r < numReaders; ++r){
+        threads.emplace_back([&map, n, r](){
+            std::mt19937 g(r);
+            std::uniform_int_distribution<int> dist(0, int(n + n / 10));
+            size_t found = 0;
+            for (size_t i = 0; i < n; ++i){
+                found += map.contains(dist(g));
+            }
+            sink += found;
+        });
+    }
+    for (std::thread &t : threads){
+        t.join();
+    }
+}
+
+template <typename map_t>
+BenchmarkResults run(std::string name, size_t n, size_t numReaders, size_t numTrials){
+    std::vector<double> times;
+    for (size_t i = 0; i < numTrials; ++i){
+        // Filled before timing, so only the concurrent reads and writes are measured
+        map_t map;
+        for (size_t key = 0; key < n; ++key){
+            map.insert(int(key), int(key));
+        }
+        times.push_back(BenchmarkLib::measure([&map, n, numReaders](){ readMostly(map, n, numReaders); }));
+    }
+    return BenchmarkResults{name + ": " + std::to_string(numReaders) + " readers", n, numTrials,
+                            BenchmarkLib::average(times), BenchmarkLib::stdev(times)};
+}
+
+}
+
+int main(int argc, char** argv) {
+
+    // Process Args
+    size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000UL;
+    size_t numTrials = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 5UL;
+    size_t maxThreads = (argc > 3) ? strtoul(argv[3], nullptr, 10) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<BenchmarkResults> results;
+    for (size_t numReaders = 1; numReaders <= maxThreads; numReaders *= 2){
+        results.push_back(concurrent::run<concurrent::MutexCuckooHashMap>("Mutex CuckooHashMap", n, numReaders, numTrials));
+        results.push_back(concurrent::run<ConcurrentCuckooHashMap<int, int>>("ConcurrentCuckooHashMap", n, numReaders, numTrials));
+    }
+
+    std::ofstream out("concurrent-cuckoo.csv");
+    out << "testName,n,numSamples,avgTime,stdev\n";
+    for (BenchmarkResults &r : results){
+        out << r.to_string() << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <vector>
+#include <string>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <fstream>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <malloc.h>
+#include <stdexcept>
+
+#include "benchmark.hpp"
+#include "cuckoo-hash/cuckoo-hash.hpp"
+#include "cuckoo-hash/cuckoo-filter.hpp"
+
+// Counts live heap bytes so the memory of a filter and a set are measured the same way
+std::atomic<size_t> heapBytes{0};
+
+void *operator new(size_t size){
+    void *p = std::malloc(size ? size : 1);
+    if (!p){
+        throw std::bad_alloc();
+    }
+    heapBytes += malloc_usable_size(p);
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    if (p){
+        heapBytes -= malloc_usable_size(p);
+        std::free(p);
+    }
+}
+
+void operator delete(void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+// Cache line aligned tables, e.g. the groups of CuckooHashSet
+void *operator new(size_t size, std::align_val_t align){
+    void *p = std::aligned_alloc(size_t(align), (size + size_t(align) - 1) / size_t(align) * size_t(align));
+    if (!p){
+        throw std::bad_alloc();
+    }
+    heapBytes += malloc_usable_size(p);
+    return p;
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept {
+    operator delete(p);
+}
+
+// Memory per key, false positive rate and speed of CuckooFilter against the
+// exact CuckooHashSet. Half of the lookups are for keys that were never inserted.
+namespace filter {
+
+// Keeps the compiler from optimizing away lookups whose result is unused
+volatile size_t sink;
+
+struct FilterResults {
+    std::string testName_;
+    size_t n_;
+    double bitsPerKey_;
+    double falsePositiveRate_;
+    double insertTime_;
+    double lookupTime_;
+
+    std::string to_string() const {
+        return testName_ + ", " + std::to_string(n_) + ", " + std::to_string(bitsPerKey_) + ", " +
+               std::to_string(falsePositiveRate_) + ", " + std::to_string(insertTime_) + ", " + std::to_string(lookupTime_);
+    }
+};
+
+// make() builds an empty structure, insert(structure, keys) fills it
+template <typename F, typename I>
+FilterResults run(std::string name, const std::vector<uint64_t>& keys, const std::vector<uint64_t>& misses, F make, I insert){
+    size_t before = heapBytes;
+    auto structure = make();
+    double insertTime = BenchmarkLib::measure([&structure, &keys, &insert](){ insert(structure, keys); });
+    size_t bytes = heapBytes - before;
+    if (std::ranges::any_of(keys, [&structure](uint64_t key){ return !structure.contains(key); })){
+        throw std::runtime_error(name + " lost keys, it was too full");
+    }
+
+    size_t falsePositives = 0;
+    double lookupTime = BenchmarkLib::measure([&structure, &keys, &misses, &falsePositives](){
+        size_t found = 0;
+        for (size_t i = 0; i < keys.size(); ++i){
+            found += structure.contains(keys[i]);
+            falsePositives += structure.contains(misses[i]);
+        }
+        sink = found;
+    });
+    return FilterResults{name, keys.size(), 8.0 * bytes / keys.size(), double(falsePositives) / misses.size(), insertTime, lookupTime};
+}
+
+FilterResults runFilter(std::string name, const std::vector<uint64_t>& keys, const std::vector<uint64_t>& misses, size_t bits){
+    return run(name, keys, misses,
+        [&keys, bits](){ return CuckooFilter<uint64_t>::withFingerprintBits(keys.size(), bits); },
+        [](CuckooFilter<uint64_t>& f, const std::vector<uint64_t>& k){ f.insertBatch(k); });
+}
+
+}
+
+int main(int argc, char** argv) {
+
+    // Process Args
+    size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000UL;
+
+    std::mt19937_64 g(7);
+    std::vector<uint64_t> keys(n), misses(n);
+    for (size_t i = 0; i < n; ++i){
+        keys[i] = g();
+        misses[i] = g();
+    }
+
+    std::vector<filter::FilterResults> results;
+    results.push_back(filter::run("CuckooHashSet<uint64_t>", keys, misses,
+        [](){ return CuckooHashSet<uint64_t>(); },
+        [](CuckooHashSet<uint64_t>& s, const std::vector<uint64_t>& k){ for (uint64_t key : k){ s.insert(key); } }));
+    for (size_t bits : {8, 12, 16}){
+        results.push_back(filter::runFilter("CuckooFilter " + std::to_string(bits) + " bit", keys, misses, bits));
+    }
+    results.push_back(filter::run("CuckooFilter 0.1% target", keys, misses,
+        [n](){ return CuckooFilter<uint64_t>(n, 0.001); },
+        [](CuckooFilter<uint64_t>& f, const std::vector<uint64_t>& k){ f.insertBatch(k); }));
+    results.push_back(filter::run("CuckooFilter insert() loop", keys, misses,
+        [n](){ return CuckooFilter<uint64_t>(n, 0.001); },
+        [](CuckooFilter<uint64_t>& f, const std::vector<uint64_t>& k){ for (uint64_t key : k){ f.insert(key); } }));
+
+    std::ofstream out("cuckoo-filter.csv");
+    out << "testName,n,bitsPerKey,falsePositiveRate,insertTime,lookupTime\n";
+    for (filter::FilterResults &r : results){
+        out << r.to_string() << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,255 @@
+#include <vector>
+#include <string>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <filesystem>
+
+#include "benchmark.hpp"
+#include "cuckoo-hash/cuckoo-hash.hpp"
+#include "cuckoo-hash/bucket-cuckoo-hash.hpp"
+
+namespace cuckoo {
+
+// Keeps the compiler from optimizing away lookups whose result is unused
+volatile size_t sink;
+
+template <typename map_t, typename key_t>
+void build(const std::vector<key_t>& keys){
+    map_t map;
+    for (const key_t& key : keys){
+        map.insert(key, 0);
+    }
+    sink = map.size();
+}
+
+// Half of the queries are in the map, half are not.
+template <typename map_t, typename key_t>
+void lookups(const map_t& map, const std::vector<key_t>& queries){
+    size_t found = 0;
+    for (const key_t& key : queries){
+        found += map.contains(key);
+    }
+    sink = found;
+}
+
+template <typename map_t, typename key_t>
+void lookupLoop(const map_t& map, const std::vector<key_t>& queries){
+    size_t found = 0;
+    for (const key_t& key : queries){
+        if (map.contains(key)){
+            found += map.lookup(key);
+        }
+    }
+    sink = found;
+}
+
+template <typename map_t, typename key_t>
+void containsBatch(const map_t& map, const std::vector<key_t>& queries){
+    std::unique_ptr<bool[]> found(new bool[queries.size()]);
+    map.containsBatch(queries, std::span<bool>(found.get(), queries.size()));
+    sink = std::count(found.get(), found.get() + queries.size(), true);
+}
+
+template <typename map_t, typename key_t>
+void lookupBatch(const map_t& map, const std::vector<key_t>& queries){
+    std::vector<int*> values(queries.size());
+    map.lookupBatch(queries, values);
+    size_t found = 0;
+    for (int *value : values){
+        if (value){
+            found += *value;
+        }
+    }
+    sink = found;
+}
+
+template <typename map_t, typename key_t>
+void addPolicyTests(BenchmarkSuite& suite, std::string name, std::vector<key_t>& keys, std::vector<key_t>& queries, map_t& map){
+    for (const key_t& key : keys){
+        map.insert(key, 0);
+    }
+    suite.addConfiguredTest(name + ": Insert", build<map_t, key_t>, std::ref(keys));
+    suite.addConfiguredTest(name + ": Lookup", lookups<map_t, key_t>, std::ref(map), std::ref(queries));
+}
+
+// Compares the original string rehash against the allocation free policies
+template <typename key_t>
+void hashPolicies(std::string suiteName, std::vector<key_t> keys, std::vector<key_t> misses, size_t numTrials){
+    std::mt19937 g(42);
+    std::vector<key_t> queries = keys;
+    queries.insert(queries.end(), misses.begin(), misses.end());
+    std::ranges::shuffle(queries, g);
+
+    CuckooHashMap<key_t, int, StringHashPolicy<key_t>> stringMap;
+    CuckooHashMap<key_t, int, MixHashPolicy<key_t>> mixMap;
+    CuckooHashMap<key_t, int, WyHashPolicy<key_t>> wyMap;
+    BucketCuckooHashMap<key_t, int, 4, MixHashPolicy<key_t>> bucketMap;
+    BucketCuckooHashMap<key_t, int, 8, MixHashPolicy<key_t>> bucket8Map;
+
+    BenchmarkSuite suite(suiteName);
+    suite.setConfig(keys.size(), numTrials);
+    addPolicyTests(suite, "String Rehash", keys, queries, stringMap);
+    addPolicyTests(suite, "Mix Hash", keys, queries, mixMap);
+    addPolicyTests(suite, "Wy Hash", keys, queries, wyMap);
+    addPolicyTests(suite, "Bucket Map Mix Hash", keys, queries, bucketMap);
+    addPolicyTests(suite, "Bucket Map (8 slots) Mix Hash", keys, queries, bucket8Map);
+    suite.run();
+    suite.resultsToCSV(suiteName + ".csv");
+}
+
+
+// Compares looping over contains()/lookup() with the prefetching batch lookups
+void batchLookups(std::vector<int> keys, std::vector<int> misses, size_t numTrials){
+    std::mt19937 g(42);
+    std::vector<int> queries = keys;
+    queries.insert(queries.end(), misses.begin(), misses.end());
+    std::ranges::shuffle(queries, g);
+
+    CuckooHashMap<int, int> map;
+    CuckooHashSet<int> set;
+    BucketCuckooHashMap<int, int> bucketMap;
+    for (int key : keys){
+        map.insert(key, key);
+        set.insert(key);
+        bucketMap.insert(key, key);
+    }
+
+    BenchmarkSuite suite("cuckoo-batch");
+    suite.setConfig(keys.size(), numTrials);
+    suite.addConfiguredTest("Map: contains() loop", lookups<CuckooHashMap<int, int>, int>, std::ref(map), std::ref(queries));
+    suite.addConfiguredTest("Map: containsBatch()", containsBatch<CuckooHashMap<int, int>, int>, std::ref(map), std::ref(queries));
+    suite.addConfiguredTest("Map: lookup() loop", lookupLoop<CuckooHashMap<int, int>, int>, std::ref(map), std::ref(queries));
+    suite.addConfiguredTest("Map: lookupBatch()", lookupBatch<CuckooHashMap<int, int>, int>, std::ref(map), std::ref(queries));
+    suite.addConfiguredTest("Set: contains() loop", lookups<CuckooHashSet<int>, int>, std::ref(set), std::ref(queries));
+    suite.addConfiguredTest("Set: containsBatch()", containsBatch<CuckooHashSet<int>, int>, std::ref(set), std::ref(queries));
+    suite.addConfiguredTest("Bucket Map: lookup() loop", lookupLoop<BucketCuckooHashMap<int, int>, int>, std::ref(bucketMap), std::ref(queries));
+    suite.addConfiguredTest("Bucket Map: lookupBatch()", lookupBatch<BucketCuckooHashMap<int, int>, int>, std::ref(bucketMap), std::ref(queries));
+    suite.run();
+    suite.resultsToCSV("cuckoo-batch.csv");
+}
+
+
+// Both copy the keys first so they only differ in how the map gets them
+void insertCopies(const std::vector<std::string>& keys){
+    std::vector<std::string> owned = keys;
+    CuckooHashMap<std::string, int> map;
+    for (std::string& key : owned){
+        map.insert(key, 0);
+    }
+    sink = map.size();
+}
+
+void tryEmplaceMoves(const std::vector<std::string>& keys){
+    std::vector<std::string> owned = keys;
+    CuckooHashMap<std::string, int> map;
+    for (std::string& key : owned){
+        map.try_emplace(std::move(key), 0);
+    }
+    sink = map.size();
+}
+
+void lookupTemporaries(const CuckooHashMap<std::string, int>& map, const std::vector<std::string_view>& queries){
+    size_t found = 0;
+    for (std::string_view key : queries){
+        found += map.contains(std::string(key));
+    }
+    sink = found;
+}
+
+void lookupViews(const CuckooHashMap<std::string, int>& map, const std::vector<std::string_view>& queries){
+    size_t found = 0;
+    for (std::string_view key : queries){
+        found += map.contains(key);
+    }
+    sink = found;
+}
+
+// Keys are longer than the small string buffer, so every std::string allocates
+void stringKeys(std::vector<int> keys, std::vector<int> misses, size_t numTrials){
+    std::vector<std::string> stringKeys, queryStrings;
+    for (size_t i = 0; i < keys.size(); ++i){
+        stringKeys.push_back("a-key-longer-than-sso-" + std::to_string(keys[i]));
+        queryStrings.push_back(stringKeys.back());
+        queryStrings.push_back("a-key-longer-than-sso-" + std::to_string(misses[i]));
+    }
+    std::vector<std::string_view> queries(queryStrings.begin(), queryStrings.end());
+    CuckooHashMap<std::string, int> map;
+    for (const std::string& key : stringKeys){
+        map.insert(key, 0);
+    }
+
+    BenchmarkSuite suite("cuckoo-string-keys");
+    suite.setConfig(keys.size(), numTrials);
+    suite.addConfiguredTest("insert()", insertCopies, std::ref(stringKeys));
+    suite.addConfiguredTest("try_emplace(std::move(key))", tryEmplaceMoves, std::ref(stringKeys));
+    suite.addConfiguredTest("contains(std::string(view))", lookupTemporaries, std::ref(map), std::ref(queries));
+    suite.addConfiguredTest("contains(view)", lookupViews, std::ref(map), std::ref(queries));
+    suite.run();
+    suite.resultsToCSV("cuckoo-string-keys.csv");
+}
+
+
+// Startup cost of a service: rebuilding the map from its keys, or opening a
+// snapshot saved by the last run. Both then look up every key once, so opening
+// also pays for reading its pages. The file is in the page cache after save().
+void rebuildAndLookup(const std::vector<int>& keys, const std::vector<int>& queries){
+    CuckooHashMap<int, int> map;
+    for (int key : keys){
+        map.insert(key, key);
+    }
+    lookups(map, queries);
+}
+
+void openAndLookup(const std::string& path, const std::vector<int>& queries){
+    CuckooHashMap<int, int> map = CuckooHashMap<int, int>::open(path);
+    lookups(map, queries);
+}
+
+void snapshots(std::vector<int> keys, size_t numTrials){
+    std::string path = "cuckoo-snapshot.bin";
+    CuckooHashMap<int, int> map;
+    for (int key : keys){
+        map.insert(key, key);
+    }
+    map.save(path);
+
+    BenchmarkSuite suite("cuckoo-snapshot");
+    suite.setConfig(keys.size(), numTrials);
+    suite.addConfiguredTest("Rebuild from keys", rebuildAndLookup, std::ref(keys), std::ref(keys));
+    suite.addConfiguredTest("open() snapshot", openAndLookup, std::ref(path), std::ref(keys));
+    suite.run();
+    suite.resultsToCSV("cuckoo-snapshot.csv");
+    std::filesystem::remove(path);
+}
+}
+
+int main(int argc, char** argv) {
+
+    // Process Args
+    size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000UL;
+    size_t numTrials = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 10UL;
+
+    std::vector<int> intKeys(2 * n);
+    std::iota(intKeys.begin(), intKeys.end(), 0);
+    std::mt19937 g(7);
+    std::ranges::shuffle(intKeys, g);
+    std::vector<int> intMisses(intKeys.begin() + n, intKeys.end());
+    intKeys.resize(n);
+    cuckoo::hashPolicies("cuckoo-int", intKeys, intMisses, numTrials);
+    cuckoo::batchLookups(intKeys, intMisses, numTrials);
+    cuckoo::stringKeys(intKeys, intMisses, numTrials);
+    cuckoo::snapshots(intKeys, numTrials);
+
+    std::vector<std::string> stringKeys, stringMisses;
+    for (size_t i = 0; i < n; ++i){
+        stringKeys.push_back("key" + std::to_string(intKeys[i]));
+        stringMisses.push_back("key" + std::to_string(intMisses[i]));
+    }
+    cuckoo::hashPolicies("cuckoo-string", stringKeys, stringMisses, numTrials);
+    return 0;
+}
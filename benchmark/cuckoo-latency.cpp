@@ -0,0 +1,103 @@
+#include <vector>
+#include <string>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+#include "cuckoo-hash/cuckoo-hash.hpp"
+
+// Measures every insert on its own and reports tail latency. Average time per
+// insert hides the rare long eviction chains and rehashes this is looking for.
+namespace latency {
+
+struct LatencyResults {
+    std::string testName_;
+    size_t n_;
+    double p50_;
+    double p99_;
+    double p999_;
+    double max_;
+
+    std::string to_string() const {
+        return testName_ + ", " + std::to_string(n_) + ", " + std::to_string(p50_) + ", " +
+               std::to_string(p99_) + ", " + std::to_string(p999_) + ", " + std::to_string(max_);
+    }
+};
+
+LatencyResults percentiles(std::string name, std::vector<double>& times){
+    std::ranges::sort(times);
+    auto at = [&times](double p){ return times[size_t(p * (times.size() - 1))]; };
+    return LatencyResults{name, times.size(), at(0.5), at(0.99), at(0.999), times.back()};
+}
+
+template <typename map_t, typename F>
+double timeInsert(map_t& map, F insert){
+    auto start = std::chrono::steady_clock::now();
+    insert(map);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// Inserts keys into an empty map, includes every resize on the way
+template <typename map_t, typename key_t>
+LatencyResults growth(std::string name, map_t& map, const std::vector<key_t>& keys){
+    std::vector<double> times;
+    times.reserve(keys.size());
+    for (const key_t& key : keys){
+        times.push_back(timeInsert(map, [&key](map_t& m){ m.insert(key, 0); }));
+    }
+    return percentiles(name + ": Growth", times);
+}
+
+// Fills the map then replaces one key at a time, the load factor stays the same
+template <typename map_t, typename key_t>
+LatencyResults churn(std::string name, map_t& map, const std::vector<key_t>& keys){
+    size_t half = keys.size() / 2;
+    for (size_t i = 0; i < half; ++i){
+        map.insert(keys[i], 0);
+    }
+    std::vector<double> times;
+    times.reserve(half);
+    for (size_t i = half; i < keys.size(); ++i){
+        map.erase(keys[i - half]);
+        times.push_back(timeInsert(map, [&keys, i](map_t& m){ m.insert(keys[i], 0); }));
+    }
+    return percentiles(name + ": Churn", times);
+}
+
+}
+
+int main(int argc, char** argv) {
+
+    // Process Args
+    size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000UL;
+
+    std::vector<int> intKeys(n);
+    std::iota(intKeys.begin(), intKeys.end(), 0);
+    std::mt19937 g(7);
+    std::ranges::shuffle(intKeys, g);
+    std::vector<std::string> stringKeys;
+    for (int key : intKeys){
+        stringKeys.push_back("key" + std::to_string(key));
+    }
+
+    std::vector<latency::LatencyResults> results;
+    for (size_t rehashStep : {0, 4}){
+        std::string mode = rehashStep ? " Incremental Rehash" : "";
+        CuckooHashMap<int, int> intGrowth(0.4, 0.2, 0, rehashStep), intChurn(0.4, 0.2, 0, rehashStep);
+        CuckooHashMap<std::string, int> stringGrowth(0.4, 0.2, 0, rehashStep), stringChurn(0.4, 0.2, 0, rehashStep);
+        results.push_back(latency::growth("CuckooHashMap<int>" + mode, intGrowth, intKeys));
+        results.push_back(latency::churn("CuckooHashMap<int>" + mode, intChurn, intKeys));
+        results.push_back(latency::growth("CuckooHashMap<string>" + mode, stringGrowth, stringKeys));
+        results.push_back(latency::churn("CuckooHashMap<string>" + mode, stringChurn, stringKeys));
+    }
+
+    std::ofstream out("cuckoo-latency.csv");
+    out << "testName,n,p50ns,p99ns,p999ns,maxns\n";
+    for (latency::LatencyResults &r : results){
+        out << r.to_string() << "\n";
+    }
+    return 0;
+}
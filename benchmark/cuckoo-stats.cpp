@@ -0,0 +1,117 @@
+#include <vector>
+#include <string>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <fstream>
+
+#include "benchmark.hpp"
+// Built with CUCKOO_HASH_STATISTICS, see benchmark/CMakeLists.txt
+#include "cuckoo-hash/cuckoo-hash.hpp"
+
+// Throughput of CuckooHashMap next to the statistics that explain it, for key
+// distributions that are easy and hard on the first hash. std::hash of an
+// integer is the integer, so keys that share their low bits all want the same
+// slot of the first table.
+namespace stats {
+
+// Keeps the compiler from optimizing away lookups whose result is unused
+volatile size_t sink;
+
+struct StatsResults {
+    std::string testName_;
+    size_t n_;
+    double insertTime_;
+    double lookupTime_;
+    CuckooHashStats insertStats_;
+    CuckooHashStats lookupStats_;
+
+    std::string to_string() const {
+        const CuckooHashStats &s = insertStats_;
+        std::string chains;
+        for (size_t length = 0; length < s.evictionChains_.size(); ++length){
+            if (s.evictionChains_[length]){
+                chains += (chains.empty() ? "" : ";") + std::to_string(length) + ":" + std::to_string(s.evictionChains_[length]);
+            }
+        }
+        return testName_ + ", " + std::to_string(n_) + ", " + std::to_string(insertTime_) + ", " +
+               std::to_string(lookupTime_) + ", " + std::to_string(lookupStats_.averageProbes()) + ", " +
+               std::to_string(s.rehashes_) + ", " + std::to_string(s.rehashSeconds_) + ", " +
+               std::to_string(s.maxRehashSeconds_) + ", " + std::to_string(s.failedPaths_) + ", " +
+               std::to_string(s.stashed_) + ", " + std::to_string(double(s.table1Items_) / s.numBuckets_) + ", " +
+               std::to_string(double(s.table2Items_) / s.numBuckets_) + ", " + chains;
+    }
+};
+
+// Inserts every key, then looks up every key and as many misses
+template <typename map_t, typename key_t>
+StatsResults run(std::string name, const std::vector<key_t>& keys, const std::vector<key_t>& misses){
+    map_t map;
+    double insertTime = BenchmarkLib::measure([&map, &keys](){
+        for (const key_t& key : keys){
+            map.insert(key, 0);
+        }
+    });
+    CuckooHashStats insertStats = map.stats();
+    map.resetStats();
+    double lookupTime = BenchmarkLib::measure([&map, &keys, &misses](){
+        size_t found = 0;
+        for (size_t i = 0; i < keys.size(); ++i){
+            found += map.contains(keys[i]);
+            found += map.contains(misses[i]);
+        }
+        sink = found;
+    });
+    return StatsResults{name, keys.size(), insertTime, lookupTime, insertStats, map.stats()};
+}
+
+template <typename key_t>
+void addPolicies(std::vector<StatsResults>& results, std::string name, const std::vector<key_t>& keys, const std::vector<key_t>& misses){
+    results.push_back(run<CuckooHashMap<key_t, int, MixHashPolicy<key_t>>>(name + ": MixHashPolicy", keys, misses));
+    results.push_back(run<CuckooHashMap<key_t, int, WyHashPolicy<key_t>>>(name + ": WyHashPolicy", keys, misses));
+}
+
+}
+
+int main(int argc, char** argv) {
+
+    // Process Args
+    size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000UL;
+
+    std::mt19937_64 g(7);
+    std::vector<size_t> sequential(2 * n);
+    std::iota(sequential.begin(), sequential.end(), 0);
+    std::ranges::shuffle(sequential, g);
+    std::vector<size_t> random(2 * n), strided(2 * n);
+    for (size_t i = 0; i < 2 * n; ++i){
+        random[i] = g();
+        strided[i] = sequential[i] << 6; // Multiples of 64, only 1 in 64 slots of the first table is used
+    }
+    std::vector<std::string> strings;
+    for (size_t key : sequential){
+        strings.push_back("key" + std::to_string(key));
+    }
+
+    std::vector<stats::StatsResults> results;
+    auto half = [n](auto keys){
+        std::vector<typename decltype(keys)::value_type> misses(keys.begin() + n, keys.end());
+        keys.resize(n);
+        return std::make_pair(keys, misses);
+    };
+    auto [sequentialKeys, sequentialMisses] = half(sequential);
+    auto [randomKeys, randomMisses] = half(random);
+    auto [stridedKeys, stridedMisses] = half(strided);
+    auto [stringKeys, stringMisses] = half(strings);
+    stats::addPolicies(results, "Sequential", sequentialKeys, sequentialMisses);
+    stats::addPolicies(results, "Random", randomKeys, randomMisses);
+    stats::addPolicies(results, "Strided", stridedKeys, stridedMisses);
+    results.push_back(stats::run<CuckooHashMap<std::string, int>>("Strings: MixHashPolicy", stringKeys, stringMisses));
+
+    std::ofstream out("cuckoo-stats.csv");
+    out << "testName,n,insertTime,lookupTime,avgProbes,rehashes,rehashTime,maxRehashTime,failedPaths,stashed,"
+           "table1Load,table2Load,evictionChains\n";
+    for (stats::StatsResults &r : results){
+        out << r.to_string() << "\n";
+    }
+    return 0;
+}
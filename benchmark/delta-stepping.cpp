@@ -0,0 +1,103 @@
+// Benchmark parallel delta-stepping against sequential Dijkstra, across
+// thread counts and bucket widths
+#include <vector>
+#include <string>
+#include <iostream>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+
+#include "graph.hpp"
+#include "randomGraphs.hpp"
+#include "largeGraphs.hpp"
+
+#include "heap/d-ary.hpp"
+#include "interfaces.hpp"
+
+#include "dijkstra.hpp"
+#include "delta-stepping.hpp"
+#include "benchmark.hpp"
+
+namespace delta {
+
+constexpr size_t RUNS = 3;
+
+struct ScalingResult {
+    std::string graph_;
+    size_t n_;
+    size_t delta_; // 0 for Dijkstra
+    size_t threads_;
+    double bestTime_; // milliseconds
+    double speedup_; // Over sequential Dijkstra with a binary heap
+
+    std::string to_string() const {
+        return BenchmarkLib::csvRow(graph_, n_, delta_, threads_, bestTime_, speedup_);
+    }
+};
+
+template <typename F>
+double bestTimeMs(F f){
+    return std::ranges::min(BenchmarkLib::measureRunsMs(RUNS, f));
+}
+
+template <typename graph_t>
+void scaling(std::vector<ScalingResult>& results, std::string name, graph_t *g, std::vector<size_t> deltas){
+    using dist_t = typename graph_t::weight_type;
+    size_t n = g->getNumVertices();
+
+    std::vector<dist_t> reference;
+    double dijkstraTime = bestTimeMs([&](){ reference = dijkstra<BinaryMinHeap<dist_t>, graph_t>(g); });
+    results.push_back(ScalingResult{name, n, 0, 1, dijkstraTime, 1});
+    std::cout << results.back().to_string() << std::endl;
+
+    for (size_t delta : deltas){
+        for (size_t threads : BenchmarkLib::threadCounts()){
+            std::vector<dist_t> paths;
+            double time = bestTimeMs([&](){ paths = deltaStepping(g, delta, threads); });
+            if (paths != reference){
+                throw std::runtime_error("Delta-stepping found different distances on " + name + " with delta " +
+                                         std::to_string(delta) + " and " + std::to_string(threads) + " threads");
+            }
+            results.push_back(ScalingResult{name, n, delta, threads, time, dijkstraTime / time});
+            std::cout << results.back().to_string() << std::endl;
+        }
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+
+    // About 2^scale vertices per large graph
+    size_t scale = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20;
+    if (argc > 2 or scale < 4 or scale > 26){
+        std::cout << "usage: " << argv[0] << " [log2 of the number of vertices, 4 to 26]\n";
+        return -1;
+    }
+    size_t n = size_t(1) << scale;
+    size_t side = size_t(std::sqrt(double(n)));
+
+    std::vector<delta::ScalingResult> results;
+    std::cout << "graph, n, delta, threads, bestTime, speedup" << std::endl;
+
+    // The 16 bit random graphs, as an adjacency list
+    RandomGraphGenerator gen(0.001, 20000);
+    GraphAdjList *small = gen.makeGraph();
+    delta::scaling(results, "Random adjacency list p = 0.001", small, {1000, 4000, 16000});
+    delete small;
+
+    // Weights are 1 to 100
+    LargeGraphGenerator large;
+    for (auto [name, generate] : std::vector<std::pair<std::string, std::function<LargeGraphCSR *()>>>{
+             {"Erdos-Renyi degree 8", [&](){ return large.erdosRenyi(n, 8); }},
+             {"R-MAT edge factor 8", [&](){ return large.rmat(scale, 8); }},
+             {"Grid", [&](){ return large.grid(side, side); }}}){
+        LargeGraphCSR *g = generate();
+        delta::scaling(results, name, g, {10, 30, 100});
+        delete g;
+    }
+
+    BenchmarkLib::writeCSV("delta-stepping.csv", "graph,n,delta,threads,bestTime,speedup", results);
+    return 0;
+}
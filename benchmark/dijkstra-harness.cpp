@@ -0,0 +1,116 @@
+// Compares every heap on the same graphs, with changeKey (dijkstra) and
+// without it (lazyDijkstra), and reports how many pushes, pops and
+// changeKeys each run makes next to its time.
+#include <vector>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "graph.hpp"
+#include "randomGraphs.hpp"
+
+#include "heap/d-ary.hpp"
+#include "heap/binomial.hpp"
+#include "heap/fibonacci.hpp"
+#include "heap/pairing.hpp"
+#include "heap/radix.hpp"
+#include "interfaces.hpp"
+#include "adaptors.hpp"
+
+#include "dijkstra.hpp"
+#include "benchmark.hpp"
+
+namespace harness {
+
+constexpr size_t RUNS = 5;
+
+struct HarnessResult {
+    std::string heap_;
+    std::string mode_; // "changeKey" or "lazy"
+    size_t n_;
+    size_t edges_;
+    HeapCounts counts_;
+    double bestTime_; // milliseconds
+    double averageTime_; // milliseconds
+
+    std::string to_string() const {
+        return BenchmarkLib::csvRow(heap_, mode_, n_, edges_, counts_.pushes_, counts_.pops_, counts_.changeKeys_,
+                                    bestTime_, averageTime_);
+    }
+};
+
+template <BasicHeap heap_t, bool LAZY>
+std::vector<uint16_t> shortestPaths(Graph *g){
+    if constexpr (LAZY) {
+        return lazyDijkstra<heap_t>(g);
+    } else {
+        return dijkstra<heap_t>(g);
+    }
+}
+
+template <BasicHeap heap_t, bool LAZY>
+void run(std::vector<HarnessResult>& results, std::string name, Graph *g, size_t edges,
+         const std::vector<uint16_t>& reference){
+    // One counted run, which also checks the distances
+    CountingHeap<heap_t>::counts_ = HeapCounts{};
+    if (shortestPaths<CountingHeap<heap_t>, LAZY>(g) != reference){
+        throw std::runtime_error(name + " found different distances");
+    }
+
+    std::vector<double> times = BenchmarkLib::measureRunsMs(RUNS, [g](){ shortestPaths<heap_t, LAZY>(g); });
+    double best = std::ranges::min(times);
+    double average = BenchmarkLib::average(times);
+    results.push_back(HarnessResult{name, LAZY ? "lazy" : "changeKey", g->getNumVertices(), edges,
+                                    CountingHeap<heap_t>::counts_, best, average});
+    std::cout << results.back().to_string() << std::endl;
+}
+
+void compareHeaps(std::vector<HarnessResult>& results, double sparsity, size_t n){
+    RandomGraphGenerator gen(sparsity, n);
+    GraphAdjList *g = gen.makeGraph();
+    size_t edges = 0;
+    for (size_t vertex = 0; vertex < n; ++vertex){
+        edges += g->edgesFromStart(vertex).size();
+    }
+    std::vector<uint16_t> reference = dijkstra<BinaryMinHeap<uint16_t>>(g);
+
+    // Items are vertices
+    run<BinaryMinHeap<uint16_t>, false>(results, "Binary Heap", g, edges, reference);
+    run<DAryHeap<uint16_t, uint16_t, 4>, false>(results, "DAry Heap D = 4", g, edges, reference);
+    run<IndexedDAryHeap<uint16_t, uint16_t, 4>, false>(results, "Indexed DAry Heap D = 4", g, edges, reference);
+    run<IndexedDAryHeap<uint16_t, uint16_t, 8>, false>(results, "Indexed DAry Heap D = 8", g, edges, reference);
+    run<PairingHeap<uint16_t, uint16_t>, false>(results, "Pairing Heap", g, edges, reference);
+    run<BinomialHeap<uint16_t, uint16_t>, false>(results, "Binomial Heap", g, edges, reference);
+    run<IndexedBinomialHeap<uint16_t, uint16_t>, false>(results, "Indexed Binomial Heap", g, edges, reference);
+    run<FibonacciHeap<uint16_t, uint16_t>, false>(results, "Fibonacci Heap", g, edges, reference);
+    run<IndexedFibonacciHeap<uint16_t, uint16_t>, false>(results, "Indexed Fibonacci Heap", g, edges, reference);
+    run<RadixHeap<uint16_t, uint16_t>, false>(results, "Radix Heap", g, edges, reference);
+    run<IndexedRadixHeap<uint16_t, uint16_t>, false>(results, "Indexed Radix Heap", g, edges, reference);
+
+    // Items are (distance, vertex) pairs, a vertex can be in the heap more than once
+    run<PQAdaptor<uint32_t, uint32_t, std::greater<uint32_t>>, true>(results, "std::priority_queue", g, edges, reference);
+    run<BinaryMinHeap<uint32_t>, true>(results, "Binary Heap", g, edges, reference);
+    run<DAryHeap<uint32_t, uint32_t, 4>, true>(results, "DAry Heap D = 4", g, edges, reference);
+    run<DAryHeap<uint32_t, uint32_t, 8>, true>(results, "DAry Heap D = 8", g, edges, reference);
+    run<PairingHeap<uint32_t, uint32_t>, true>(results, "Pairing Heap", g, edges, reference);
+    run<BinomialHeap<uint32_t, uint32_t>, true>(results, "Binomial Heap", g, edges, reference);
+    run<FibonacciHeap<uint32_t, uint32_t>, true>(results, "Fibonacci Heap", g, edges, reference);
+    run<RadixHeap<uint32_t, uint32_t>, true>(results, "Radix Heap", g, edges, reference);
+
+    delete g;
+}
+
+}
+
+int main(){
+
+    std::vector<harness::HarnessResult> results;
+    std::cout << "heap, mode, n, edges, pushes, pops, changeKeys, bestTime, averageTime" << std::endl;
+    for (auto [sparsity, n] : std::vector<std::pair<double, size_t>>{{0.001, 20000}, {0.01, 20000}, {0.1, 5000}, {0.001, 60000}}){
+        harness::compareHeaps(results, sparsity, n);
+    }
+
+    BenchmarkLib::writeCSV("dijkstra-harness.csv", "heap,mode,n,edges,pushes,pops,changeKeys,bestTime,averageTime", results);
+    return 0;
+}
@@ -13,51 +13,11 @@
 #include "heap/binomial.hpp"
 #include "heap/fibonacci.hpp"
 #include "heap/pairing.hpp"
+#include "heap/radix.hpp"
 #include "interfaces.hpp"
+#include "adaptors.hpp" // for std::priority_queue
 
-
-
-/**
- * @brief Implementation of Dijkstra's algorithm that takes in a graph 
- * and returns a vector of the distance from vertex 0 to any other point
- * 
- * @tparam heap_t Type of heap to use
- * @param g Graph
- * @return std::vector<size_t> Vector of the distances. 
- */
-template <Heap heap_t>
-std::vector<uint16_t> dijkstra(Graph *g){
-
-    uint16_t n = g->getNumVertices();
-    std::vector<uint16_t> paths(n);
-    std::ranges::fill(paths, std::numeric_limits<uint16_t>::max());
-    paths[0] = 0;
-
-    heap_t h;
-    for (uint16_t vertex_i = 0; vertex_i < n; ++vertex_i){
-        h.push(vertex_i, paths[vertex_i]);
-    }
-
-    while (!h.empty()){
-        size_t vertex = h.top();
-        h.pop();
-        size_t value = paths[vertex];
-
-        // Get repeated edges
-        std::vector<Edge> adjacent = g->edgesFromStart(vertex);
-        for (Edge& e : adjacent){
-            if (value != std::numeric_limits<size_t>::max()) {
-                size_t offer = value + e.weight;
-                if (paths[e.outgoing] > offer){
-                    // Update weight:
-                    h.changeKey(e.outgoing, offer);
-                    paths[e.outgoing] = offer;
-                }
-            }
-        }
-    }
-    return paths;
-}
+#include "dijkstra.hpp"
 
 
 int main(){
@@ -76,10 +36,16 @@ int main(){
             suite.addVaryingInputs("Dijkstra DAry Heap 5 Matrix", dijkstra<DAryHeap<size_t, size_t, 5>>, mat);
             suite.addVaryingInputs("Dijkstra DAry Heap 10 List", dijkstra<DAryHeap<size_t, size_t, 10>>, list);
             suite.addVaryingInputs("Dijkstra DAry Heap 10 Matrix", dijkstra<DAryHeap<size_t, size_t, 10>>, mat);
+            suite.addVaryingInputs("Dijkstra Indexed Binary Heap List", dijkstra<IndexedDAryHeap<size_t, size_t>>, list);
+            suite.addVaryingInputs("Dijkstra Indexed DAry Heap 5 List", dijkstra<IndexedDAryHeap<size_t, size_t, 5>>, list);
             suite.addVaryingInputs("Dijkstra Binomial Heap List", dijkstra<BinomialHeap<size_t, size_t>>, list);
             suite.addVaryingInputs("Dijkstra Binomial Heap Matrix", dijkstra<BinomialHeap<size_t, size_t>>, mat);
             suite.addVaryingInputs("Dijkstra Fibonacci Heap List", dijkstra<FibonacciHeap<size_t, size_t>>, list);
             suite.addVaryingInputs("Dijkstra Fibonacci Heap Matrix", dijkstra<FibonacciHeap<size_t, size_t>>, mat);
+            suite.addVaryingInputs("Dijkstra Indexed Binomial Heap List", dijkstra<IndexedBinomialHeap<size_t, size_t>>, list);
+            suite.addVaryingInputs("Dijkstra Indexed Fibonacci Heap List", dijkstra<IndexedFibonacciHeap<size_t, size_t>>, list);
+            suite.addVaryingInputs("Dijkstra Radix Heap List", dijkstra<RadixHeap<size_t, size_t>>, list);
+            suite.addVaryingInputs("Dijkstra Indexed Radix Heap List", dijkstra<IndexedRadixHeap<size_t, size_t>>, list);
             suite.run();
 
             // Clean up memory NOW
@@ -103,14 +69,32 @@ int main(){
             suite.setConfig(n, 10);
             RandomGraphGenerator gen(sparsity, n);
             GraphAdjList *g = gen.makeGraph();
+            GraphCSR *csr = new GraphCSR(g);
             suite.addConfiguredTest("Dijkstra DAry Heap D = 2", dijkstra<BinaryMinHeap<uint16_t>>, std::ref(g));
-            suite.addConfiguredTest("Dijkstra DAry Heap D = 5", dijkstra<DAryHeap<uint16_t, uint16_t>>, std::ref(g));
-            suite.addConfiguredTest("Dijkstra DAry Heap D = 10", dijkstra<DAryHeap<uint16_t, uint16_t>>, std::ref(g));
+            suite.addConfiguredTest("Dijkstra DAry Heap D = 5", dijkstra<DAryHeap<uint16_t, uint16_t, 5>>, std::ref(g));
+            suite.addConfiguredTest("Dijkstra DAry Heap D = 10", dijkstra<DAryHeap<uint16_t, uint16_t, 10>>, std::ref(g));
+            suite.addConfiguredTest("Dijkstra Indexed DAry Heap D = 2", dijkstra<IndexedDAryHeap<uint16_t, uint16_t>>, std::ref(g));
+            suite.addConfiguredTest("Dijkstra Indexed DAry Heap D = 5", dijkstra<IndexedDAryHeap<uint16_t, uint16_t, 5>>, std::ref(g));
             suite.addConfiguredTest("Dijkstra Binomial Heap", dijkstra<BinomialHeap<uint16_t, uint16_t>>, std::ref(g));
             suite.addConfiguredTest("Dijkstra Fibonacci Heap", dijkstra<FibonacciHeap<uint16_t, uint16_t>>, std::ref(g));
+            suite.addConfiguredTest("Dijkstra Indexed Binomial Heap", dijkstra<IndexedBinomialHeap<uint16_t, uint16_t>>, std::ref(g));
+            suite.addConfiguredTest("Dijkstra Indexed Fibonacci Heap", dijkstra<IndexedFibonacciHeap<uint16_t, uint16_t>>, std::ref(g));
             suite.addConfiguredTest("Dijkstra Pairing Heap", dijkstra<PairingHeap<uint16_t, uint16_t>>, std::ref(g));
+            suite.addConfiguredTest("Dijkstra Radix Heap", dijkstra<RadixHeap<uint16_t, uint16_t>>, std::ref(g));
+            suite.addConfiguredTest("Dijkstra Indexed Radix Heap", dijkstra<IndexedRadixHeap<uint16_t, uint16_t>>, std::ref(g));
+            suite.addConfiguredTest("Lazy Dijkstra std::priority_queue", lazyDijkstra<PQAdaptor<uint32_t, uint32_t, std::greater<uint32_t>>>, std::ref(g));
+            suite.addConfiguredTest("Lazy Dijkstra DAry Heap D = 4", lazyDijkstra<DAryHeap<uint32_t, uint32_t, 4>>, std::ref(g));
+            suite.addConfiguredTest("Lazy Dijkstra Radix Heap", lazyDijkstra<RadixHeap<uint32_t, uint32_t>>, std::ref(g));
+            // Same graph stored as CSR, so the edges are not copied for every vertex
+            suite.addConfiguredTest("Dijkstra CSR DAry Heap D = 2", dijkstra<BinaryMinHeap<uint16_t>, GraphCSR>, std::ref(csr));
+            suite.addConfiguredTest("Dijkstra CSR Indexed DAry Heap D = 5", dijkstra<IndexedDAryHeap<uint16_t, uint16_t, 5>, GraphCSR>, std::ref(csr));
+            suite.addConfiguredTest("Dijkstra CSR Indexed Fibonacci Heap", dijkstra<IndexedFibonacciHeap<uint16_t, uint16_t>, GraphCSR>, std::ref(csr));
+            suite.addConfiguredTest("Dijkstra CSR Pairing Heap", dijkstra<PairingHeap<uint16_t, uint16_t>, GraphCSR>, std::ref(csr));
+            suite.addConfiguredTest("Dijkstra CSR Indexed Radix Heap", dijkstra<IndexedRadixHeap<uint16_t, uint16_t>, GraphCSR>, std::ref(csr));
+            suite.addConfiguredTest("Lazy Dijkstra CSR std::priority_queue", lazyDijkstra<PQAdaptor<uint32_t, uint32_t, std::greater<uint32_t>>, GraphCSR>, std::ref(csr));
             suite.run();
             suite.resultsToCSV("dijkstra_" + sparsityStr + ".csv");
+            delete csr;
             delete g;
         }
         suite.resultsToCSV("dijkstra_" + sparsityStr + ".csv");
@@ -130,10 +114,18 @@ int main(){
         results["Binary Heap"].push_back(result);
         result = BenchmarkLib::measure(dijkstra<DAryHeap<uint16_t, uint16_t, 10>>, std::ref(g));
         results["DAry Heap D = 10"].push_back(result);
+        result = BenchmarkLib::measure(dijkstra<IndexedDAryHeap<uint16_t, uint16_t>>, std::ref(g));
+        results["Indexed Binary Heap"].push_back(result);
+        result = BenchmarkLib::measure(dijkstra<IndexedDAryHeap<uint16_t, uint16_t, 10>>, std::ref(g));
+        results["Indexed DAry Heap D = 10"].push_back(result);
         result = BenchmarkLib::measure(dijkstra<FibonacciHeap<uint16_t, uint16_t>>, std::ref(g));
         results["Fibonacci Heap"].push_back(result);
+        result = BenchmarkLib::measure(dijkstra<IndexedFibonacciHeap<uint16_t, uint16_t>>, std::ref(g));
+        results["Indexed Fibonacci Heap"].push_back(result);
         result = BenchmarkLib::measure(dijkstra<PairingHeap<uint16_t, uint16_t>>, std::ref(g));
         results["Pairing Heap"].push_back(result);
+        result = BenchmarkLib::measure(dijkstra<IndexedRadixHeap<uint16_t, uint16_t>>, std::ref(g));
+        results["Indexed Radix Heap"].push_back(result);
     }
     delete g;
 
@@ -0,0 +1,99 @@
+#include <vector>
+#include <string>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+#include "heap/binomial.hpp"
+#include "heap/fibonacci.hpp"
+#include "heap/pairing.hpp"
+#include "interfaces.hpp"
+#include "benchmark.hpp"
+
+// Combining k per-thread heaps of n items in total into one. merge() against
+// popping every shard and pushing its items into the first one. The first pop
+// after combining is timed on its own, it pays for the deferred consolidation
+// of the Binomial and Fibonacci root lists.
+namespace merge {
+
+struct MergeResults {
+    std::string testName_;
+    size_t n_;
+    size_t shards_;
+    double combineTime_; // milliseconds
+    double firstPopTime_; // milliseconds
+    double drainTime_; // milliseconds, the remaining pops
+
+    std::string to_string() const {
+        return BenchmarkLib::csvRow(testName_, n_, shards_, combineTime_, firstPopTime_, drainTime_);
+    }
+};
+
+// Shard s holds the items i with i % k == s
+template <typename heap_t>
+std::vector<heap_t> makeShards(const std::vector<uint32_t>& priorities, size_t k){
+    std::vector<heap_t> shards(k);
+    for (size_t i = 0; i < priorities.size(); ++i){
+        shards[i % k].push(uint32_t(i), priorities[i]);
+    }
+    return shards;
+}
+
+template <MeldableHeap heap_t, typename C>
+MergeResults run(std::string name, const std::vector<uint32_t>& priorities, size_t k, C combine){
+    std::vector<heap_t> shards = makeShards<heap_t>(priorities, k);
+    double combineTime = BenchmarkLib::measureMs([&shards, &combine](){ combine(shards); });
+    heap_t &all = shards[0];
+    if (all.size() != priorities.size()){
+        throw std::runtime_error(name + " lost items");
+    }
+    double firstPopTime = BenchmarkLib::measureMs([&all](){ all.pop(); });
+    double drainTime = BenchmarkLib::measureMs([&all](){
+        while (!all.empty()){
+            all.pop();
+        }
+    });
+    return MergeResults{name, priorities.size(), k, combineTime, firstPopTime, drainTime};
+}
+
+template <MeldableHeap heap_t>
+void addHeap(std::vector<MergeResults>& results, std::string name, const std::vector<uint32_t>& priorities, size_t k){
+    results.push_back(run<heap_t>(name + ": merge", priorities, k, [](std::vector<heap_t>& shards){
+        for (size_t s = 1; s < shards.size(); ++s){
+            shards[0].merge(std::move(shards[s]));
+        }
+    }));
+    results.push_back(run<heap_t>(name + ": pop and push", priorities, k, [&priorities](std::vector<heap_t>& shards){
+        for (size_t s = 1; s < shards.size(); ++s){
+            while (!shards[s].empty()){
+                uint32_t item = shards[s].top();
+                shards[s].pop();
+                shards[0].push(item, priorities[item]);
+            }
+        }
+    }));
+}
+
+}
+
+int main(int argc, char** argv) {
+
+    // Process Args
+    size_t n = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000UL;
+
+    std::mt19937 g(7);
+    std::vector<uint32_t> priorities(n);
+    std::iota(priorities.begin(), priorities.end(), 0);
+    std::ranges::shuffle(priorities, g);
+
+    std::vector<merge::MergeResults> results;
+    for (size_t k : {2, 8, 32, 128}){
+        merge::addHeap<PairingHeap<uint32_t, uint32_t>>(results, "Pairing Heap", priorities, k);
+        merge::addHeap<BinomialHeap<uint32_t, uint32_t>>(results, "Binomial Heap", priorities, k);
+        merge::addHeap<FibonacciHeap<uint32_t, uint32_t>>(results, "Fibonacci Heap", priorities, k);
+    }
+
+    BenchmarkLib::writeCSV("heap-merge.csv", "testName,n,shards,combineTime,firstPopTime,drainTime", results);
+    return 0;
+}
@@ -20,8 +20,17 @@ template <BasicHeap heap_t>
 std::vector<uint32_t> findKofN(std::vector<uint32_t>& numbers, size_t k){
     // Set up a heap with the max k items
     heap_t maxK;
-    for (size_t i = 0; i < k; ++i){
-        maxK.push(numbers[i], numbers[i]);
+    if constexpr (BulkHeap<heap_t>) {
+        std::vector<std::pair<typename heap_t::value_type, typename heap_t::priority_type>> items;
+        items.reserve(k);
+        for (size_t i = 0; i < k; ++i){
+            items.push_back({numbers[i], numbers[i]});
+        }
+        maxK.push_range(items.begin(), items.end());
+    } else {
+        for (size_t i = 0; i < k; ++i){
+            maxK.push(numbers[i], numbers[i]);
+        }
     }
 
     // Iterate over the items and add to the heap if necessary
@@ -49,8 +58,17 @@ template <typename heap_t>
 std::vector<uint32_t> hsort(std::vector<uint32_t> v){
     // Put into a heap
     heap_t h;
-    for (uint32_t& x : v){
-        h.push(x,x);
+    if constexpr (BulkHeap<heap_t>) {
+        std::vector<std::pair<typename heap_t::value_type, typename heap_t::priority_type>> items;
+        items.reserve(v.size());
+        for (uint32_t& x : v){
+            items.push_back({x, x});
+        }
+        h.push_range(items.begin(), items.end());
+    } else {
+        for (uint32_t& x : v){
+            h.push(x,x);
+        }
     }
     // Pop out from heap in sorted order
     std::vector<uint32_t> sorted;
@@ -79,11 +97,14 @@ void kofn(size_t n){
         suite.setConfig(k, 10);
         suite.addConfiguredTest("std::priority_queue", findKofN<PQAdaptor<uint32_t, uint32_t>>, std::ref(numbers),  std::ref(k));
         suite.addConfiguredTest("Binary Heap", findKofN<BinaryMinHeap<uint32_t>>, std::ref(numbers), std::ref(k));
+        suite.addConfiguredTest("DAry Heap D = 4", findKofN<DAryHeap<uint32_t, uint32_t, 4>>, std::ref(numbers),  std::ref(k));
         suite.addConfiguredTest("DAry Heap D = 5", findKofN<DAryHeap<uint32_t, uint32_t, 5>>, std::ref(numbers),  std::ref(k));
+        suite.addConfiguredTest("DAry Heap D = 8", findKofN<DAryHeap<uint32_t, uint32_t, 8>>, std::ref(numbers),  std::ref(k));
         suite.addConfiguredTest("DAryHeap D = 10", findKofN<DAryHeap<uint32_t, uint32_t, 10>>, std::ref(numbers),  std::ref(k));
+        suite.addConfiguredTest("DAryHeap D = 16", findKofN<DAryHeap<uint32_t, uint32_t, 16>>, std::ref(numbers),  std::ref(k));
         suite.addConfiguredTest("Binomial Heap", findKofN<BinomialHeap<uint32_t, uint32_t>>, std::ref(numbers),  std::ref(k));
         suite.addConfiguredTest("Fibonacci Heap", findKofN<FibonacciHeap<uint32_t, uint32_t>>, std::ref(numbers),  std::ref(k));
-        suite.addConfiguredTest("Pairing Heap", findKofN<PairingHeap<int, int>>, std::move(numbers), std::ref(k));
+        suite.addConfiguredTest("Pairing Heap", findKofN<PairingHeap<int, int>>, std::ref(numbers), std::ref(k));
 
         suite.run();
     }
@@ -101,13 +122,16 @@ void heapsort(size_t n) {
 
     BenchmarkSuite suite("Heap Sort");
     suite.setConfig(n, 10);
-    suite.addConfiguredTest("std::priority_queue", hsort<PQAdaptor<uint32_t, uint32_t>>, std::move(numbers));
-    suite.addConfiguredTest("Binary Heap", hsort<BinaryMinHeap<uint32_t>>, std::move(numbers));
-    suite.addConfiguredTest("DAry Heap D = 5", hsort<DAryHeap<uint32_t, uint32_t, 5>>, std::move(numbers));
-    suite.addConfiguredTest("DAryHeap D = 10", hsort<DAryHeap<uint32_t, uint32_t, 10>>, std::move(numbers));
-    suite.addConfiguredTest("Binomial Heap", hsort<BinomialHeap<uint32_t, uint32_t>>, std::move(numbers));
-    suite.addConfiguredTest("Fibonacci Heap", hsort<FibonacciHeap<uint32_t, uint32_t>>, std::move(numbers));
-    suite.addConfiguredTest("Pairing Heap", hsort<PairingHeap<int, int>>, std::move(numbers));
+    suite.addConfiguredTest("std::priority_queue", hsort<PQAdaptor<uint32_t, uint32_t>>, std::ref(numbers));
+    suite.addConfiguredTest("Binary Heap", hsort<BinaryMinHeap<uint32_t>>, std::ref(numbers));
+    suite.addConfiguredTest("DAry Heap D = 4", hsort<DAryHeap<uint32_t, uint32_t, 4>>, std::ref(numbers));
+    suite.addConfiguredTest("DAry Heap D = 5", hsort<DAryHeap<uint32_t, uint32_t, 5>>, std::ref(numbers));
+    suite.addConfiguredTest("DAry Heap D = 8", hsort<DAryHeap<uint32_t, uint32_t, 8>>, std::ref(numbers));
+    suite.addConfiguredTest("DAryHeap D = 10", hsort<DAryHeap<uint32_t, uint32_t, 10>>, std::ref(numbers));
+    suite.addConfiguredTest("DAryHeap D = 16", hsort<DAryHeap<uint32_t, uint32_t, 16>>, std::ref(numbers));
+    suite.addConfiguredTest("Binomial Heap", hsort<BinomialHeap<uint32_t, uint32_t>>, std::ref(numbers));
+    suite.addConfiguredTest("Fibonacci Heap", hsort<FibonacciHeap<uint32_t, uint32_t>>, std::ref(numbers));
+    suite.addConfiguredTest("Pairing Heap", hsort<PairingHeap<int, int>>, std::ref(numbers));
     suite.run();
     suite.resultsToCSV("heapsort.csv");
 }
@@ -5,12 +5,18 @@
  * Adaptors defined:
  * std::priority_queue<T> satisfying the BasicHeap concept
  * Quack<T> satisfying the Queue voncept
+ * CountingHeap<heap_t> counting the operations on any BasicHeap or Heap
+ * LockedHeap<heap_t> sharing any BasicHeap between threads, like MultiQueue
  */
 #pragma once
 
 #include <queue>
+#include <mutex>
+#include <optional>
+#include <utility>
 
 #include "quack/quack.hpp"
+#include "interfaces.hpp"
 
 
 template <typename T, typename P, typename Compare = std::less<T>>
@@ -43,4 +49,63 @@ public:
     void pop_front() { q_.dequeue(); }
     void pop_back() { q_.pop(); }
     size_t size() { return q_.size(); }
-};
\ No newline at end of file
+};
+
+struct HeapCounts {
+    size_t pushes_ = 0;
+    size_t pops_ = 0;
+    size_t changeKeys_ = 0;
+};
+
+// Forwards to heap_t and counts its operations. The counts are shared by all
+// CountingHeap<heap_t> objects, since algorithms build their heaps internally.
+// Reset them before each run.
+template <BasicHeap heap_t>
+class CountingHeap {
+    heap_t heap_;
+
+public:
+    using value_type = typename heap_t::value_type;
+    using priority_type = typename heap_t::priority_type;
+
+    static inline HeapCounts counts_;
+
+    bool empty() { return heap_.empty(); }
+    size_t size() { return heap_.size(); }
+    value_type top() { return heap_.top(); }
+    void pop() { ++counts_.pops_; heap_.pop(); }
+    void push(value_type item, priority_type priority) { ++counts_.pushes_; heap_.push(item, priority); }
+    void changeKey(value_type item, priority_type priority) requires Heap<heap_t> {
+        ++counts_.changeKeys_;
+        heap_.changeKey(item, priority);
+    }
+};
+
+// One mutex around heap_t, with the tryPop() of MultiQueue so both can be
+// shared by threads. The baseline for concurrent priority queues. heap_t
+// needs topPriority(), as DAryHeap has.
+template <BasicHeap heap_t>
+class LockedHeap {
+    heap_t heap_;
+    mutable std::mutex mutex_;
+
+public:
+    using value_type = typename heap_t::value_type;
+    using priority_type = typename heap_t::priority_type;
+
+    bool empty() const { std::lock_guard lock(mutex_); return heap_.empty(); }
+    size_t size() const { std::lock_guard lock(mutex_); return heap_.size(); }
+    void push(const value_type &item, priority_type priority) {
+        std::lock_guard lock(mutex_);
+        heap_.push(item, priority);
+    }
+    std::optional<std::pair<value_type, priority_type>> tryPop() {
+        std::lock_guard lock(mutex_);
+        if (heap_.empty()){
+            return std::nullopt;
+        }
+        std::pair<value_type, priority_type> popped{heap_.top(), heap_.topPriority()};
+        heap_.pop();
+        return popped;
+    }
+};
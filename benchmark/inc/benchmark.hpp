@@ -15,6 +15,8 @@
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <chrono>
+#include <type_traits>
 
 namespace BenchmarkLib {
     // Utiility Functions 
@@ -27,8 +29,54 @@ namespace BenchmarkLib {
         auto start = std::chrono::steady_clock::now();
         func(std::forward<Args...>(args)...);
         auto end = std::chrono::steady_clock::now();
-        long ms = std::chrono::duration_cast<std::chrono::milliseconds>((end - start)).count();
-        return double(ms / 1000.0);
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    // Milliseconds one call to f takes, at the steady clock's full resolution
+    template <typename F>
+    double measureMs(F f){
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    // Milliseconds each of runs calls to f takes
+    template <typename F>
+    std::vector<double> measureRunsMs(size_t runs, F f){
+        std::vector<double> times;
+        for (size_t run_i = 0; run_i < runs; ++run_i){
+            times.push_back(measureMs(f));
+        }
+        return times;
+    }
+
+    // 1, 2, 4, ... up to the hardware threads, and at least up to 4
+    std::vector<size_t> threadCounts();
+
+    // One CSV field: strings as they are, numbers through std::to_string
+    inline std::string csvField(const std::string& field){ return field; }
+
+    template <typename T> requires std::is_arithmetic_v<T>
+    std::string csvField(T field){ return std::to_string(field); }
+
+    // Fields joined with ", ", the way BenchmarkResults::to_string writes them
+    template <typename... Fields>
+    std::string csvRow(const Fields&... fields){
+        std::string row;
+        bool first = true;
+        ((row += first ? "" : ", ", row += csvField(fields), first = false), ...);
+        return row;
+    }
+
+    // Writes the header and then one r.to_string() line per result
+    template <typename R>
+    void writeCSV(const std::string& filename, const std::string& header, const std::vector<R>& results){
+        std::ofstream out(filename);
+        out << header << "\n";
+        for (const R& r : results){
+            out << r.to_string() << "\n";
+        }
     }
 }
 
@@ -70,8 +118,7 @@ double Benchmark::measure(F f, Args&&... args){
     auto start = std::chrono::steady_clock::now();
     f(std::forward<Args...>(args)...);
     auto end = std::chrono::steady_clock::now();
-    long ms = std::chrono::duration_cast<std::chrono::milliseconds>((end - start)).count();
-    return double(ms / 1000.0);
+    return std::chrono::duration<double>(end - start).count();
 }
 
 struct BenchmarkResults {
@@ -129,8 +176,7 @@ class BenchmarkSuite {
             auto start = std::chrono::steady_clock::now();
             std::apply(func_, args_);
             auto end = std::chrono::steady_clock::now();
-            long ms = std::chrono::duration_cast<std::chrono::milliseconds>((end - start)).count();
-            return double(ms / 1000.0);
+            return std::chrono::duration<double>(end - start).count();
         };
     };
 
@@ -164,8 +210,7 @@ class BenchmarkSuite {
             auto start = std::chrono::steady_clock::now();
             func_(arg);
             auto end = std::chrono::steady_clock::now();
-            long ms = std::chrono::duration_cast<std::chrono::milliseconds>((end - start)).count();
-            return double(ms / 1000.0);
+            return std::chrono::duration<double>(end - start).count();
         };
     };
 
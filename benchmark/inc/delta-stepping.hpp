@@ -0,0 +1,171 @@
+// Parallel single source shortest paths by delta-stepping (Meyer and Sanders)
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <barrier>
+#include <algorithm>
+#include <stdexcept>
+
+#include "graph.hpp"
+
+/**
+ * @brief Delta-stepping from vertex 0: vertices are kept in buckets of
+ * width delta by tentative distance, and the lowest bucket is settled by
+ * relaxing the edges of all its vertices at once, in parallel.
+ *
+ * Light edges (weight <= delta) can put vertices back into the current
+ * bucket, so they are relaxed in rounds until the bucket stays empty. Heavy
+ * edges can only reach later buckets and are relaxed once, after the bucket
+ * is settled. delta = 1 behaves like Dijkstra, a huge delta like Bellman-Ford.
+ *
+ * A team of threads is started once per search. Between rounds the threads
+ * meet at a barrier, where one of them picks the next round's frontier.
+ *
+ * @tparam graph_t Graph or GraphCSR, of any vertex and weight type
+ * @param g Graph
+ * @param delta Width of a bucket, at least 1
+ * @param numThreads Threads relaxing edges, 0 for every hardware thread
+ * @return Vector of the distances, same as dijkstra()
+ */
+template <typename graph_t>
+std::vector<typename graph_t::weight_type> deltaStepping(const graph_t *g, size_t delta, size_t numThreads = 0){
+    using vertex_t = typename graph_t::vertex_type;
+    using dist_t = typename graph_t::weight_type;
+    constexpr dist_t UNREACHED = std::numeric_limits<dist_t>::max();
+    constexpr size_t CHUNK = 64; // Vertices a thread takes from the frontier at a time
+
+    if (delta == 0){
+        throw std::invalid_argument("Delta must be at least 1");
+    }
+    if (numThreads == 0){
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    size_t n = g->getNumVertices();
+    std::vector<std::atomic<dist_t>> dist(n);
+    for (std::atomic<dist_t> &d : dist){
+        d.store(UNREACHED, std::memory_order_relaxed);
+    }
+
+    // buckets[t][i]: vertices thread t moved into bucket i. A vertex moved
+    // again to a lower bucket stays in the old one and is skipped there.
+    std::vector<std::vector<std::vector<vertex_t>>> buckets(numThreads);
+    std::vector<vertex_t> frontier; // Vertices of the current round
+    std::vector<vertex_t> settled; // Vertices of the current bucket, for its heavy edges
+    std::atomic<size_t> next{0}; // Next unclaimed position in frontier
+    size_t current = 0; // Bucket being settled
+    enum class Round { Light, Heavy, Done } round = Round::Heavy;
+
+    if (n){
+        dist[0].store(0, std::memory_order_relaxed);
+        buckets[0].resize(1);
+        buckets[0][0].push_back(0);
+    }
+
+    // Takes bucket i out of every thread into frontier, returns whether it had any vertex
+    auto takeBucket = [&](size_t i){
+        frontier.clear();
+        for (auto &own : buckets){
+            if (i < own.size()){
+                frontier.insert(frontier.end(), own[i].begin(), own[i].end());
+                own[i].clear();
+            }
+        }
+        return !frontier.empty();
+    };
+
+    // Runs on one thread while the others wait, and picks the next round
+    auto pickRound = [&]() noexcept {
+        next.store(0, std::memory_order_relaxed);
+        if (round == Round::Light and takeBucket(current)){
+            // The light edges put vertices back into this bucket
+            settled.insert(settled.end(), frontier.begin(), frontier.end());
+            return;
+        }
+        if (round == Round::Light){
+            frontier.swap(settled);
+            settled.clear();
+            round = Round::Heavy;
+            return;
+        }
+        // After the heavy edges of a bucket, or at the start: settle the lowest nonempty bucket
+        size_t lowest = std::numeric_limits<size_t>::max();
+        for (auto &own : buckets){
+            for (size_t i = current; i < std::min(own.size(), lowest); ++i){
+                if (!own[i].empty()){
+                    lowest = i;
+                    break;
+                }
+            }
+        }
+        if (lowest == std::numeric_limits<size_t>::max()){
+            round = Round::Done;
+            return;
+        }
+        current = lowest;
+        takeBucket(current);
+        settled = frontier;
+        round = Round::Light;
+    };
+    std::barrier sync(numThreads, pickRound);
+
+    auto worker = [&](size_t t){
+        std::vector<std::vector<vertex_t>> &own = buckets[t];
+        // Lowers the distance of u to offer if it is shorter
+        auto relax = [&](vertex_t u, uint64_t offer){
+            dist_t seen = dist[u].load(std::memory_order_relaxed);
+            while (offer < seen){
+                if (dist[u].compare_exchange_weak(seen, dist_t(offer), std::memory_order_relaxed)){
+                    size_t i = offer / delta;
+                    if (i >= own.size()){
+                        own.resize(i + 1);
+                    }
+                    own[i].push_back(u);
+                    return;
+                }
+            }
+        };
+
+        while (true){
+            sync.arrive_and_wait();
+            if (round == Round::Done){
+                return;
+            }
+            bool light = round == Round::Light;
+            for (size_t first = next.fetch_add(CHUNK, std::memory_order_relaxed); first < frontier.size();
+                 first = next.fetch_add(CHUNK, std::memory_order_relaxed)){
+                for (size_t pos = first; pos < std::min(first + CHUNK, frontier.size()); ++pos){
+                    vertex_t vertex = frontier[pos];
+                    uint64_t d = dist[vertex].load(std::memory_order_relaxed);
+                    if (d / delta != current){
+                        continue; // Already settled in a lower bucket
+                    }
+                    for (const auto &e : adjacentEdges(g, vertex)){
+                        if ((e.weight <= delta) == light){
+                            relax(e.outgoing, d + e.weight);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t){
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread &thread : threads){
+        thread.join();
+    }
+
+    std::vector<dist_t> paths(n);
+    for (size_t vertex = 0; vertex < n; ++vertex){
+        paths[vertex] = dist[vertex].load(std::memory_order_relaxed);
+    }
+    return paths;
+}
@@ -0,0 +1,104 @@
+// Dijkstra's algorithm over the heap interfaces in "interfaces.hpp"
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+
+#include "graph.hpp"
+#include "interfaces.hpp"
+
+/**
+ * @brief Implementation of Dijkstra's algorithm that takes in a graph 
+ * and returns a vector of the distance from vertex 0 to any other point
+ * 
+ * @tparam heap_t Type of heap to use
+ * @tparam graph_t Graph, or GraphCSR to iterate its edges without copying them.
+ * Distances have the weight type of the graph.
+ * @param g Graph
+ * @return std::vector<size_t> Vector of the distances. 
+ */
+template <Heap heap_t, typename graph_t = Graph>
+std::vector<typename graph_t::weight_type> dijkstra(graph_t *g){
+    using vertex_t = typename graph_t::vertex_type;
+    using dist_t = typename graph_t::weight_type;
+
+    vertex_t n = g->getNumVertices();
+    std::vector<dist_t> paths(n);
+    std::ranges::fill(paths, std::numeric_limits<dist_t>::max());
+    paths[0] = 0;
+
+    heap_t h;
+    for (vertex_t vertex_i = 0; vertex_i < n; ++vertex_i){
+        h.push(vertex_i, paths[vertex_i]);
+    }
+
+    while (!h.empty()){
+        size_t vertex = h.top();
+        h.pop();
+        size_t value = paths[vertex];
+
+        for (const auto& e : adjacentEdges(g, vertex)){
+            if (value != std::numeric_limits<size_t>::max()) {
+                size_t offer = value + e.weight;
+                if (paths[e.outgoing] > offer){
+                    // Update weight:
+                    h.changeKey(e.outgoing, offer);
+                    paths[e.outgoing] = offer;
+                }
+            }
+        }
+    }
+    return paths;
+}
+
+/**
+ * @brief Dijkstra's algorithm without changeKey. A vertex is pushed every
+ * time its distance improves, and entries that are no longer its distance
+ * are skipped when they are popped.
+ *
+ * Items are (distance << bits of a vertex | vertex), so a vertex pushed
+ * twice gives two distinct items for heaps that index their items, and heaps
+ * that ignore the priority (PQAdaptor) still order by distance.
+ *
+ * @tparam heap_t Min heap with items wide enough for a distance and a vertex,
+ * 32 bits for Graph and 64 for LargeGraph
+ * @tparam graph_t Graph or GraphCSR, as for dijkstra()
+ * @param g Graph
+ * @return Vector of the distances, same as dijkstra()
+ */
+template <BasicHeap heap_t, typename graph_t = Graph>
+std::vector<typename graph_t::weight_type> lazyDijkstra(graph_t *g){
+    using item_t = typename heap_t::value_type;
+    using vertex_t = typename graph_t::vertex_type;
+    using dist_t = typename graph_t::weight_type;
+    constexpr size_t VERTEX_BITS = 8 * sizeof(vertex_t);
+    static_assert(sizeof(item_t) >= sizeof(vertex_t) + sizeof(dist_t), "Items hold a distance and a vertex");
+
+    vertex_t n = g->getNumVertices();
+    std::vector<dist_t> paths(n);
+    std::ranges::fill(paths, std::numeric_limits<dist_t>::max());
+    paths[0] = 0;
+
+    heap_t h;
+    h.push(0, 0);
+    while (!h.empty()){
+        item_t entry = h.top();
+        h.pop();
+        vertex_t vertex = vertex_t(entry);
+        size_t value = size_t(entry >> VERTEX_BITS);
+        if (value > paths[vertex]){
+            continue; // Stale: the vertex was pushed again with a shorter distance
+        }
+
+        for (const auto& e : adjacentEdges(g, vertex)){
+            size_t offer = value + e.weight;
+            if (paths[e.outgoing] > offer){
+                paths[e.outgoing] = offer;
+                h.push(item_t(item_t(offer) << VERTEX_BITS | e.outgoing), offer);
+            }
+        }
+    }
+    return paths;
+}
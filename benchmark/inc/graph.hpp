@@ -2,52 +2,120 @@
 #pragma once
 
 #include <vector>
+#include <span>
 #include <cstdint>
+#include <type_traits>
+
+// Every graph class takes V, the vertex id type, and W, the edge weight type.
+// Graph, Edge, ... are the 16 bit versions used by most benchmarks, LargeGraph,
+// LargeEdge, ... the 32 bit versions for graphs with millions of vertices.
+// The classes are compiled for these two pairs of types only, in graph.cpp.
 
 // Edge Struct
-struct Edge {
-    uint16_t outgoing;
-    uint16_t weight;
+template <typename V, typename W>
+struct BasicEdge {
+    V outgoing;
+    W weight;
 };
 
 // Abstract base class for graphs
-class Graph
+template <typename V, typename W>
+class BasicGraph
 {
 private:
 protected:
-    const uint16_t v_;
+    const V v_;
 
   public:
-    Graph(uint16_t v);
-    virtual ~Graph() = default;
+    using vertex_type = V;
+    using weight_type = W;
+    using edge_type = BasicEdge<V, W>;
+
+    BasicGraph(V v);
+    virtual ~BasicGraph() = default;
 
 
-    virtual void addEdge(uint16_t start, uint16_t end, uint16_t weight) = 0;
-    virtual std::vector<Edge> edgesFromStart(uint16_t start) const = 0;
-    uint16_t getNumVertices() const;
+    virtual void addEdge(V start, V end, W weight) = 0;
+    virtual std::vector<edge_type> edgesFromStart(V start) const = 0;
+    V getNumVertices() const;
 };
 
-class GraphAdjList : public Graph
+template <typename V, typename W>
+class BasicGraphAdjList : public BasicGraph<V, W>
 {
 private:
-    std::vector<std::vector<Edge>> adjList_;
+    using edge_type = BasicEdge<V, W>;
+    std::vector<std::vector<edge_type>> adjList_;
+
+  public:
+    BasicGraphAdjList(V v);
+    ~BasicGraphAdjList();
+
+    void addEdge(V start, V end, W weight) override;
+    std::vector<edge_type> edgesFromStart(V start) const override;
+};
+
+template <typename V, typename W>
+class BasicGraphAdjMatrix : public BasicGraph<V, W> {
+    using edge_type = BasicEdge<V, W>;
+    std::vector<W> adjMatrix_;
 
   public:
-    GraphAdjList(uint16_t v);
-    ~GraphAdjList();
+        BasicGraphAdjMatrix(V v);
+        ~BasicGraphAdjMatrix();
+
+    void addEdge(V start, V end, W weight) override;
+    std::vector<edge_type> edgesFromStart(V start) const override;
 
-    void addEdge(uint16_t start, uint16_t end, uint16_t weight) override;
-    std::vector<Edge> edgesFromStart(uint16_t start) const override;
 };
 
-class GraphAdjMatrix : public Graph {
-    std::vector<uint16_t> adjMatrix_;
+// Compressed sparse row graph: the edges out of each vertex sit next to each
+// other in one array, and offsets_[v] is where the edges of v start.
+// Built once from another graph, edges cannot be added afterwards.
+template <typename V, typename W>
+class BasicGraphCSR : public BasicGraph<V, W> {
+    using edge_type = BasicEdge<V, W>;
+    std::vector<size_t> offsets_; // v_ + 1 entries, the edges of v are [offsets_[v], offsets_[v + 1])
+    std::vector<edge_type> edges_;
 
   public:
-        GraphAdjMatrix(uint16_t v);
-        ~GraphAdjMatrix();
+    explicit BasicGraphCSR(const BasicGraph<V, W> *g);
+    // Takes arrays laid out as above, offsets has one entry more than there are vertices
+    BasicGraphCSR(std::vector<size_t> offsets, std::vector<edge_type> edges);
+    ~BasicGraphCSR();
+
+    void addEdge(V start, V end, W weight) override;
+    std::vector<edge_type> edgesFromStart(V start) const override;
+    size_t numEdges() const { return edges_.size(); }
+
+    // Edges out of start without copying them. Defined here so searches can inline it.
+    std::span<const edge_type> edges(V start) const {
+        return {edges_.data() + offsets_[start], edges_.data() + offsets_[start + 1]};
+    }
+};
+
+using Edge = BasicEdge<uint16_t, uint16_t>;
+using Graph = BasicGraph<uint16_t, uint16_t>;
+using GraphAdjList = BasicGraphAdjList<uint16_t, uint16_t>;
+using GraphAdjMatrix = BasicGraphAdjMatrix<uint16_t, uint16_t>;
+using GraphCSR = BasicGraphCSR<uint16_t, uint16_t>;
+
+using LargeEdge = BasicEdge<uint32_t, uint32_t>;
+using LargeGraph = BasicGraph<uint32_t, uint32_t>;
+using LargeGraphAdjList = BasicGraphAdjList<uint32_t, uint32_t>;
+using LargeGraphCSR = BasicGraphCSR<uint32_t, uint32_t>;
+
+// Edges out of vertex, as a view for graphs that can give one
+template <typename V, typename W>
+std::vector<BasicEdge<V, W>> adjacentEdges(const BasicGraph<V, W> *g, std::type_identity_t<V> vertex){
+    return g->edgesFromStart(vertex);
+}
 
-    void addEdge(uint16_t start, uint16_t end, uint16_t weight) override;
-    std::vector<Edge> edgesFromStart(uint16_t start) const override;
+template <typename V, typename W>
+std::span<const BasicEdge<V, W>> adjacentEdges(const BasicGraphCSR<V, W> *g, std::type_identity_t<V> vertex){
+    return g->edges(vertex);
+}
 
-};
\ No newline at end of file
+// Graph with every edge of g turned around, for searching backwards from a target
+template <typename V, typename W>
+BasicGraphAdjList<V, W> *reverseGraph(const BasicGraph<V, W> *g);
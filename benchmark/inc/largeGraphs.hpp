@@ -0,0 +1,45 @@
+// Generates random graphs with millions of vertices on several threads,
+// straight into CSR form
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "graph.hpp"
+
+// Compiled for the (V, W) pairs of Graph and LargeGraph, see graph.hpp
+template <typename V, typename W>
+class ParallelGraphGenerator
+{
+private:
+    size_t threads_;
+    uint64_t seed_;
+    W maxWeight_; // Weights are uniform in [1, maxWeight_]
+
+    // Runs emitEdges(thread, emit) on every thread, where emit(start, end, weight)
+    // adds one edge, then sorts the edges by start vertex into a CSR graph
+    template <typename F>
+    BasicGraphCSR<V, W> *build(size_t n, F emitEdges) const;
+
+public:
+    // threads = 0 uses every hardware thread. The same seed and number of
+    // threads always give the same graph.
+    ParallelGraphGenerator(size_t threads = 0, uint64_t seed = 42, W maxWeight = 100);
+    ~ParallelGraphGenerator() = default;
+
+    size_t threads() const { return threads_; }
+
+    // Directed G(n, p) with p = averageDegree / (n - 1), no self loops
+    BasicGraphCSR<V, W> *erdosRenyi(size_t n, double averageDegree) const;
+
+    // R-MAT power law graph with 2^scale vertices and edgeFactor * 2^scale edges.
+    // Each edge picks a quadrant of the adjacency matrix scale times, with
+    // probabilities a, b, c and 1 - a - b - c. Defaults are Graph500's.
+    // Self loops are dropped and duplicate edges are kept.
+    BasicGraphCSR<V, W> *rmat(size_t scale, size_t edgeFactor, double a = 0.57, double b = 0.19, double c = 0.19) const;
+
+    // rows x cols grid, vertex r * cols + c has an edge to each of its 4 neighbours
+    BasicGraphCSR<V, W> *grid(size_t rows, size_t cols) const;
+};
+
+using LargeGraphGenerator = ParallelGraphGenerator<uint32_t, uint32_t>;
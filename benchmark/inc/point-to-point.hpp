@@ -0,0 +1,234 @@
+// Point to point shortest path searches over the heap interfaces in "interfaces.hpp"
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+
+#include "graph.hpp"
+#include "interfaces.hpp"
+
+namespace PointToPoint {
+
+constexpr uint32_t UNREACHED = std::numeric_limits<uint32_t>::max();
+
+/**
+ * @brief Distances found by one search. Kept between queries and reset in
+ * time proportional to the vertices the last search reached, so a short
+ * search does not pay for clearing the whole graph.
+ */
+class Distances {
+    std::vector<uint32_t> dist_;
+    std::vector<uint16_t> reached_;
+
+  public:
+    explicit Distances(size_t n) : dist_(n, UNREACHED) {}
+
+    uint32_t operator[](uint16_t vertex) const { return dist_[vertex]; }
+
+    void set(uint16_t vertex, uint32_t dist){
+        if (dist_[vertex] == UNREACHED){
+            reached_.push_back(vertex);
+        }
+        dist_[vertex] = dist;
+    }
+
+    size_t reached() const { return reached_.size(); }
+
+    void reset(){
+        for (uint16_t vertex : reached_){
+            dist_[vertex] = UNREACHED;
+        }
+        reached_.clear();
+    }
+};
+
+// Offers dist to vertex, pushing it the first time it is reached
+template <Heap heap_t>
+bool relax(heap_t &h, Distances &dist, uint16_t vertex, uint32_t offer, uint32_t key){
+    if (dist[vertex] <= offer){
+        return false;
+    }
+    if (dist[vertex] == UNREACHED){
+        h.push(vertex, key);
+    } else {
+        h.changeKey(vertex, key);
+    }
+    dist.set(vertex, offer);
+    return true;
+}
+
+/**
+ * @brief Distances from source to every vertex
+ *
+ * @tparam heap_t Heap with uint16_t items and uint32_t priorities
+ */
+template <Heap heap_t>
+std::vector<uint32_t> distancesFrom(const Graph *g, uint16_t source){
+    Distances dist(g->getNumVertices());
+    heap_t h;
+    relax(h, dist, source, 0, 0);
+    while (!h.empty()){
+        uint16_t vertex = h.top();
+        h.pop();
+        for (const Edge &e : g->edgesFromStart(vertex)){
+            relax(h, dist, e.outgoing, dist[vertex] + e.weight, dist[vertex] + e.weight);
+        }
+    }
+    std::vector<uint32_t> all(g->getNumVertices());
+    for (uint16_t vertex = 0; vertex < g->getNumVertices(); ++vertex){
+        all[vertex] = dist[vertex];
+    }
+    return all;
+}
+
+// A* without a heuristic searches like Dijkstra
+struct ZeroHeuristic {
+    uint32_t operator()(uint16_t, uint16_t) const { return 0; }
+};
+
+/**
+ * @brief ALT heuristic: lower bounds from the triangle inequality over the
+ * distances to and from a few landmarks. Consistent, so A* never reopens a
+ * vertex and the keys it pops never decrease. Vertices that reach no
+ * landmark the target reaches cannot reach the target, they get UNREACHED.
+ */
+class LandmarkHeuristic {
+    size_t k_;
+    std::vector<uint32_t> from_; // from_[v * k_ + i]: landmark i to v
+    std::vector<uint32_t> to_;   // to_[v * k_ + i]: v to landmark i
+
+  public:
+    // Picks k landmarks far from each other, starting from first
+    template <Heap heap_t>
+    static LandmarkHeuristic build(const Graph *g, const Graph *reverse, size_t k, uint16_t first){
+        LandmarkHeuristic h;
+        size_t n = g->getNumVertices();
+        h.k_ = k;
+        h.from_.resize(n * k);
+        h.to_.resize(n * k);
+        std::vector<uint32_t> nearest(n, UNREACHED); // Distance to the closest landmark so far
+        uint16_t landmark = first;
+        for (size_t i = 0; i < k; ++i){
+            std::vector<uint32_t> from = distancesFrom<heap_t>(g, landmark);
+            std::vector<uint32_t> to = distancesFrom<heap_t>(reverse, landmark);
+            for (size_t vertex = 0; vertex < n; ++vertex){
+                h.from_[vertex * k + i] = from[vertex];
+                h.to_[vertex * k + i] = to[vertex];
+                nearest[vertex] = std::min(nearest[vertex], from[vertex]);
+            }
+            // The next landmark is the reachable vertex farthest from all landmarks
+            uint32_t farthest = 0;
+            for (size_t vertex = 0; vertex < n; ++vertex){
+                if (nearest[vertex] != UNREACHED and nearest[vertex] > farthest){
+                    farthest = nearest[vertex];
+                    landmark = uint16_t(vertex);
+                }
+            }
+        }
+        return h;
+    }
+
+    uint32_t operator()(uint16_t vertex, uint16_t target) const {
+        uint32_t bound = 0;
+        const uint32_t *fromV = &from_[vertex * k_], *fromT = &from_[target * k_];
+        const uint32_t *toV = &to_[vertex * k_], *toT = &to_[target * k_];
+        for (size_t i = 0; i < k_; ++i){
+            // d(L, t) <= d(L, v) + d(v, t)
+            if (fromT[i] != UNREACHED and fromV[i] != UNREACHED and fromT[i] > fromV[i]){
+                bound = std::max(bound, fromT[i] - fromV[i]);
+            }
+            // d(v, L) <= d(v, t) + d(t, L)
+            if (toT[i] != UNREACHED and toV[i] == UNREACHED){
+                return UNREACHED;
+            }
+            if (toT[i] != UNREACHED and toV[i] > toT[i]){
+                bound = std::max(bound, toV[i] - toT[i]);
+            }
+        }
+        return bound;
+    }
+};
+
+/**
+ * @brief A* from source to target. Stops when the target is popped.
+ *
+ * @tparam heap_t Heap with uint16_t items and uint32_t priorities
+ * @tparam Heuristic Callable (vertex, target) -> lower bound on their distance, consistent,
+ * or UNREACHED if vertex cannot reach target
+ * @param dist Distances from source, must be reset
+ * @return uint32_t Distance from source to target, or UNREACHED
+ */
+template <Heap heap_t, typename Heuristic>
+uint32_t aStar(const Graph *g, uint16_t source, uint16_t target, const Heuristic &heuristic, Distances &dist){
+    heap_t h;
+    if (heuristic(source, target) == UNREACHED){
+        return UNREACHED;
+    }
+    relax(h, dist, source, 0, heuristic(source, target));
+    while (!h.empty()){
+        uint16_t vertex = h.top();
+        if (vertex == target){
+            return dist[target];
+        }
+        h.pop();
+        for (const Edge &e : g->edgesFromStart(vertex)){
+            uint32_t offer = dist[vertex] + e.weight;
+            if (offer < dist[e.outgoing]){
+                uint32_t estimate = heuristic(e.outgoing, target);
+                if (estimate != UNREACHED){
+                    relax(h, dist, e.outgoing, offer, offer + estimate);
+                }
+            }
+        }
+    }
+    return UNREACHED;
+}
+
+/**
+ * @brief Dijkstra from source and, over the reversed graph, from target,
+ * expanding the side with the smaller key until the two frontiers prove no
+ * shorter path through them exists.
+ *
+ * @tparam heap_t Heap with uint16_t items and uint32_t priorities
+ * @param reverse g with every edge turned around
+ * @param forward, backward Distances from source and to target, must be reset
+ * @return uint32_t Distance from source to target, or UNREACHED
+ */
+template <Heap heap_t>
+uint32_t bidirectionalDijkstra(const Graph *g, const Graph *reverse, uint16_t source, uint16_t target,
+                               Distances &forward, Distances &backward){
+    heap_t forwardHeap, backwardHeap;
+    relax(forwardHeap, forward, source, 0, 0);
+    relax(backwardHeap, backward, target, 0, 0);
+    uint64_t best = source == target ? 0 : UNREACHED;
+
+    // Pops the top of one side and relaxes its edges, noting paths that meet the other side
+    auto step = [&best](const Graph *graph, heap_t &h, Distances &dist, const Distances &other){
+        uint16_t vertex = h.top();
+        h.pop();
+        for (const Edge &e : graph->edgesFromStart(vertex)){
+            uint32_t offer = dist[vertex] + e.weight;
+            if (relax(h, dist, e.outgoing, offer, offer) and other[e.outgoing] != UNREACHED){
+                best = std::min<uint64_t>(best, uint64_t(offer) + other[e.outgoing]);
+            }
+        }
+    };
+
+    while (!forwardHeap.empty() and !backwardHeap.empty()){
+        uint32_t forwardKey = forward[forwardHeap.top()];
+        uint32_t backwardKey = backward[backwardHeap.top()];
+        if (uint64_t(forwardKey) + backwardKey >= best){
+            break;
+        }
+        if (forwardKey <= backwardKey){
+            step(g, forwardHeap, forward, backward);
+        } else {
+            step(reverse, backwardHeap, backward, forward);
+        }
+    }
+    return uint32_t(best);
+}
+
+}
@@ -0,0 +1,104 @@
+// Benchmark heaps with Dijkstra's algorithm on graphs with millions of
+// vertices: Erdos-Renyi, R-MAT and grid graphs, generated in parallel.
+#include <vector>
+#include <string>
+#include <iostream>
+#include <functional>
+#include <stdexcept>
+#include <cmath>
+
+#include "graph.hpp"
+#include "largeGraphs.hpp"
+
+#include "heap/d-ary.hpp"
+#include "heap/binomial.hpp"
+#include "heap/fibonacci.hpp"
+#include "heap/pairing.hpp"
+#include "heap/radix.hpp"
+#include "interfaces.hpp"
+#include "adaptors.hpp"
+
+#include "dijkstra.hpp"
+#include "benchmark.hpp"
+
+namespace large {
+
+struct LargeResult {
+    std::string graph_;
+    std::string heap_;
+    size_t n_;
+    size_t edges_;
+    double time_; // milliseconds
+
+    std::string to_string() const {
+        return BenchmarkLib::csvRow(graph_, heap_, n_, edges_, time_);
+    }
+};
+
+template <typename heap_t, bool LAZY = false>
+void run(std::vector<LargeResult>& results, std::string graph, std::string name, LargeGraphCSR *g,
+         const std::vector<uint32_t>& reference){
+    std::vector<uint32_t> paths;
+    double time = BenchmarkLib::measureMs([&](){
+        if constexpr (LAZY) {
+            paths = lazyDijkstra<heap_t, LargeGraphCSR>(g);
+        } else {
+            paths = dijkstra<heap_t, LargeGraphCSR>(g);
+        }
+    });
+    if (paths != reference){
+        throw std::runtime_error(name + " found different distances on " + graph);
+    }
+    results.push_back(LargeResult{graph, name, g->getNumVertices(), g->numEdges(), time});
+    std::cout << results.back().to_string() << std::endl;
+}
+
+void compareHeaps(std::vector<LargeResult>& results, std::string graph, std::function<LargeGraphCSR *()> generate){
+    LargeGraphCSR *g = nullptr;
+    double generation = BenchmarkLib::measureMs([&](){ g = generate(); });
+    results.push_back(LargeResult{graph, "Generation", g->getNumVertices(), g->numEdges(), generation});
+    std::cout << results.back().to_string() << std::endl;
+
+    std::vector<uint32_t> reference = dijkstra<IndexedDAryHeap<uint32_t, uint32_t, 4>, LargeGraphCSR>(g);
+
+    run<BinaryMinHeap<uint32_t>>(results, graph, "Binary Heap", g, reference);
+    run<IndexedDAryHeap<uint32_t, uint32_t, 2>>(results, graph, "Indexed Binary Heap", g, reference);
+    run<IndexedDAryHeap<uint32_t, uint32_t, 4>>(results, graph, "Indexed DAry Heap D = 4", g, reference);
+    run<IndexedDAryHeap<uint32_t, uint32_t, 8>>(results, graph, "Indexed DAry Heap D = 8", g, reference);
+    run<PairingHeap<uint32_t, uint32_t>>(results, graph, "Pairing Heap", g, reference);
+    run<IndexedBinomialHeap<uint32_t, uint32_t>>(results, graph, "Indexed Binomial Heap", g, reference);
+    run<IndexedFibonacciHeap<uint32_t, uint32_t>>(results, graph, "Indexed Fibonacci Heap", g, reference);
+    run<IndexedRadixHeap<uint32_t, uint32_t>>(results, graph, "Indexed Radix Heap", g, reference);
+    // Items are (distance, vertex) pairs
+    run<PQAdaptor<uint64_t, uint64_t, std::greater<uint64_t>>, true>(results, graph, "Lazy std::priority_queue", g, reference);
+    run<DAryHeap<uint64_t, uint64_t, 4>, true>(results, graph, "Lazy DAry Heap D = 4", g, reference);
+    run<RadixHeap<uint64_t, uint64_t>, true>(results, graph, "Lazy Radix Heap", g, reference);
+
+    delete g;
+}
+
+}
+
+int main(int argc, char** argv) {
+
+    // About 2^scale vertices per graph
+    size_t scale = argc > 1 ? strtoul(argv[1], nullptr, 10) : 21;
+    if (argc > 2 or scale < 4 or scale > 26){
+        std::cout << "usage: " << argv[0] << " [log2 of the number of vertices, 4 to 26]\n";
+        return -1;
+    }
+    size_t n = size_t(1) << scale;
+    size_t side = size_t(std::sqrt(double(n)));
+
+    LargeGraphGenerator gen;
+    std::cout << "Generating with " << gen.threads() << " threads" << std::endl;
+
+    std::vector<large::LargeResult> results;
+    std::cout << "graph, heap, n, edges, time" << std::endl;
+    large::compareHeaps(results, "Erdos-Renyi degree 8", [&](){ return gen.erdosRenyi(n, 8); });
+    large::compareHeaps(results, "R-MAT edge factor 8", [&](){ return gen.rmat(scale, 8); });
+    large::compareHeaps(results, "Grid", [&](){ return gen.grid(side, side); });
+
+    BenchmarkLib::writeCSV("large-graphs.csv", "graph,heap,n,edges,time", results);
+    return 0;
+}
@@ -65,6 +65,15 @@ double BenchmarkLib::stdev(std::vector<double> &vec) {
     return std::sqrt(deviation / vec.size());
 }
 
+std::vector<size_t> BenchmarkLib::threadCounts() {
+    size_t most = std::max<size_t>(4, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+    for (size_t threads = 1; threads <= most; threads *= 2){
+        counts.push_back(threads);
+    }
+    return counts;
+}
+
 // BENCHMARK SUITE
 
 BenchmarkSuite::BenchmarkSuite(std::string suitename):suiteName_{suitename}{}
@@ -1,58 +1,125 @@
 #include "graph.hpp"
 #include <iostream>
+#include <stdexcept>
 
-Graph::Graph(uint16_t v):v_{v}{}
+template <typename V, typename W>
+BasicGraph<V, W>::BasicGraph(V v):v_{v}{}
 
-uint16_t Graph::getNumVertices() const { return v_; };
+template <typename V, typename W>
+V BasicGraph<V, W>::getNumVertices() const { return v_; };
 
 //Adjacency List Graphs
-GraphAdjList::GraphAdjList(uint16_t v) : Graph(v)
+template <typename V, typename W>
+BasicGraphAdjList<V, W>::BasicGraphAdjList(V v) : BasicGraph<V, W>(v)
 {
-    adjList_.resize(v_);
+    adjList_.resize(this->v_);
 }
 
-GraphAdjList::~GraphAdjList() {}
+template <typename V, typename W>
+BasicGraphAdjList<V, W>::~BasicGraphAdjList() {}
 
-void GraphAdjList::addEdge(uint16_t start, uint16_t end, uint16_t weight){
-    if (start < v_ and end < v_){
+template <typename V, typename W>
+void BasicGraphAdjList<V, W>::addEdge(V start, V end, W weight){
+    if (start < this->v_ and end < this->v_){
         adjList_[start].push_back({end, weight});
     }
 }
 
 
 
-std::vector<Edge> GraphAdjList::edgesFromStart(uint16_t start)const{
+template <typename V, typename W>
+std::vector<BasicEdge<V, W>> BasicGraphAdjList<V, W>::edgesFromStart(V start)const{
     return std::move(adjList_[start]);
 }
 
 // Adjacency Matrix Graphs
-GraphAdjMatrix::GraphAdjMatrix(uint16_t v) : Graph(v) {
+template <typename V, typename W>
+BasicGraphAdjMatrix<V, W>::BasicGraphAdjMatrix(V v) : BasicGraph<V, W>(v) {
     if (v > 20000){
         throw std::invalid_argument("Maximum size of graph is 20000 vertices due to memory usage");
     }
-    adjMatrix_.resize(v_ * v_);
+    adjMatrix_.resize(size_t(this->v_) * this->v_);
 }
 
-GraphAdjMatrix::~GraphAdjMatrix() {}
+template <typename V, typename W>
+BasicGraphAdjMatrix<V, W>::~BasicGraphAdjMatrix() {}
 
 // Indexing: All starts are in the same row
-void GraphAdjMatrix::addEdge(uint16_t start, uint16_t end, uint16_t weight){
-    if (start < v_ && end < v_){
-        size_t index = start * v_ + end;
+template <typename V, typename W>
+void BasicGraphAdjMatrix<V, W>::addEdge(V start, V end, W weight){
+    if (start < this->v_ && end < this->v_){
+        size_t index = size_t(start) * this->v_ + end;
         adjMatrix_[index] = weight;
     }
 }
 
-std::vector<Edge> GraphAdjMatrix::edgesFromStart(uint16_t start) const{
-    size_t startIndex = start * v_;
-    size_t endIndex = startIndex + v_;
-    std::vector<Edge> edges;
+template <typename V, typename W>
+std::vector<BasicEdge<V, W>> BasicGraphAdjMatrix<V, W>::edgesFromStart(V start) const{
+    size_t startIndex = size_t(start) * this->v_;
+    std::vector<edge_type> edges;
     // i is the end vertex
-    for (uint16_t i = 0; i < v_; ++i) {
-        uint16_t weight = adjMatrix_[startIndex + i];
+    for (V i = 0; i < this->v_; ++i) {
+        W weight = adjMatrix_[startIndex + i];
         if (weight) {
-            edges.push_back(Edge{i, weight});
+            edges.push_back(edge_type{i, weight});
         }
     }
     return edges;
-}
\ No newline at end of file
+}
+
+// Compressed Sparse Row Graphs
+template <typename V, typename W>
+BasicGraphCSR<V, W>::BasicGraphCSR(const BasicGraph<V, W> *g) : BasicGraph<V, W>(g->getNumVertices()) {
+    offsets_.reserve(size_t(this->v_) + 1);
+    offsets_.push_back(0);
+    for (V start = 0; start < this->v_; ++start){
+        std::vector<edge_type> edges = g->edgesFromStart(start);
+        edges_.insert(edges_.end(), edges.begin(), edges.end());
+        offsets_.push_back(edges_.size());
+    }
+}
+
+template <typename V, typename W>
+BasicGraphCSR<V, W>::BasicGraphCSR(std::vector<size_t> offsets, std::vector<edge_type> edges)
+    : BasicGraph<V, W>(V(offsets.size() - 1)), offsets_{std::move(offsets)}, edges_{std::move(edges)} {
+    if (offsets_.empty() or offsets_.back() != edges_.size()){
+        throw std::invalid_argument("The last offset must be the number of edges");
+    }
+}
+
+template <typename V, typename W>
+BasicGraphCSR<V, W>::~BasicGraphCSR() {}
+
+template <typename V, typename W>
+void BasicGraphCSR<V, W>::addEdge(V, V, W){
+    throw std::logic_error("Cannot add edges to a GraphCSR, build it from a graph that has them");
+}
+
+template <typename V, typename W>
+std::vector<BasicEdge<V, W>> BasicGraphCSR<V, W>::edgesFromStart(V start) const{
+    std::span<const edge_type> e = edges(start);
+    return std::vector<edge_type>(e.begin(), e.end());
+}
+
+template <typename V, typename W>
+BasicGraphAdjList<V, W> *reverseGraph(const BasicGraph<V, W> *g){
+    BasicGraphAdjList<V, W> *reverse = new BasicGraphAdjList<V, W>(g->getNumVertices());
+    for (V start = 0; start < g->getNumVertices(); ++start){
+        for (const BasicEdge<V, W> &e : g->edgesFromStart(start)){
+            reverse->addEdge(e.outgoing, start, e.weight);
+        }
+    }
+    return reverse;
+}
+
+// The types the benchmarks use
+template class BasicGraph<uint16_t, uint16_t>;
+template class BasicGraphAdjList<uint16_t, uint16_t>;
+template class BasicGraphAdjMatrix<uint16_t, uint16_t>;
+template class BasicGraphCSR<uint16_t, uint16_t>;
+template GraphAdjList *reverseGraph(const Graph *g);
+
+template class BasicGraph<uint32_t, uint32_t>;
+template class BasicGraphAdjList<uint32_t, uint32_t>;
+template class BasicGraphCSR<uint32_t, uint32_t>;
+template LargeGraphAdjList *reverseGraph(const LargeGraph *g);
@@ -0,0 +1,185 @@
+#include "largeGraphs.hpp"
+#include <vector>
+#include <thread>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+template <typename V, typename W>
+ParallelGraphGenerator<V, W>::ParallelGraphGenerator(size_t threads, uint64_t seed, W maxWeight)
+    : threads_{threads}, seed_{seed}, maxWeight_{maxWeight} {
+    if (threads_ == 0){
+        threads_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (maxWeight_ == 0){
+        throw std::invalid_argument("Maximum weight must be at least 1");
+    }
+}
+
+template <typename V, typename W>
+template <typename F>
+BasicGraphCSR<V, W> *ParallelGraphGenerator<V, W>::build(size_t n, F emitEdges) const {
+    if (n == 0 or n > std::numeric_limits<V>::max()){
+        throw std::invalid_argument("Number of vertices does not fit the vertex type");
+    }
+    struct Arc {
+        V start;
+        BasicEdge<V, W> edge;
+    };
+
+    // Thread t owns the vertices [t * chunk, (t + 1) * chunk)
+    size_t chunk = (n + threads_ - 1) / threads_;
+    auto rangeStart = [n, chunk](size_t t){ return std::min(n, t * chunk); };
+
+    // Step 1: Every thread generates edges, sorted into buckets by owner of the start vertex
+    std::vector<std::vector<std::vector<Arc>>> buckets(threads_, std::vector<std::vector<Arc>>(threads_));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threads_; ++t){
+        threads.emplace_back([&buckets, &emitEdges, chunk, t](){
+            auto emit = [&bucket = buckets[t], chunk](V start, V end, W weight){
+                bucket[start / chunk].push_back(Arc{start, {end, weight}});
+            };
+            emitEdges(t, emit);
+        });
+    }
+    for (std::thread &thread : threads){
+        thread.join();
+    }
+    threads.clear();
+
+    // Step 2: Every thread counting sorts the edges of its own vertices
+    std::vector<std::vector<size_t>> localOffsets(threads_);
+    std::vector<std::vector<BasicEdge<V, W>>> localEdges(threads_);
+    for (size_t t = 0; t < threads_; ++t){
+        threads.emplace_back([&, t](){
+            size_t first = rangeStart(t), count = rangeStart(t + 1) - first;
+            std::vector<size_t> &offsets = localOffsets[t];
+            offsets.assign(count + 1, 0);
+            size_t edges = 0;
+            for (size_t from = 0; from < threads_; ++from){
+                for (const Arc &arc : buckets[from][t]){
+                    ++offsets[arc.start - first + 1];
+                }
+                edges += buckets[from][t].size();
+            }
+            for (size_t vertex = 0; vertex < count; ++vertex){
+                offsets[vertex + 1] += offsets[vertex];
+            }
+            std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+            localEdges[t].resize(edges);
+            for (size_t from = 0; from < threads_; ++from){
+                for (const Arc &arc : buckets[from][t]){
+                    localEdges[t][next[arc.start - first]++] = arc.edge;
+                }
+                std::vector<Arc>().swap(buckets[from][t]);
+            }
+        });
+    }
+    for (std::thread &thread : threads){
+        thread.join();
+    }
+    threads.clear();
+
+    // Step 3: Concatenate the ranges, each thread copying its own
+    std::vector<size_t> bases(threads_ + 1, 0);
+    for (size_t t = 0; t < threads_; ++t){
+        bases[t + 1] = bases[t] + localEdges[t].size();
+    }
+    std::vector<size_t> offsets(n + 1);
+    std::vector<BasicEdge<V, W>> edges(bases.back());
+    for (size_t t = 0; t < threads_; ++t){
+        threads.emplace_back([&, t](){
+            size_t first = rangeStart(t), count = rangeStart(t + 1) - first;
+            for (size_t vertex = 0; vertex < count; ++vertex){
+                offsets[first + vertex] = bases[t] + localOffsets[t][vertex];
+            }
+            std::ranges::copy(localEdges[t], edges.begin() + bases[t]);
+            std::vector<BasicEdge<V, W>>().swap(localEdges[t]);
+        });
+    }
+    for (std::thread &thread : threads){
+        thread.join();
+    }
+    offsets[n] = edges.size();
+    return new BasicGraphCSR<V, W>(std::move(offsets), std::move(edges));
+}
+
+template <typename V, typename W>
+BasicGraphCSR<V, W> *ParallelGraphGenerator<V, W>::erdosRenyi(size_t n, double averageDegree) const {
+    if (n < 2 or averageDegree <= 0 or averageDegree > n - 1){
+        throw std::invalid_argument("Average degree must be between 0 and n - 1");
+    }
+    double p = averageDegree / (n - 1);
+    size_t chunk = (n + threads_ - 1) / threads_;
+    return build(n, [this, n, p, chunk](size_t t, auto emit){
+        std::mt19937_64 rng(seed_ + t);
+        std::uniform_int_distribution<W> weight(1, maxWeight_);
+        // Skips straight to the next edge instead of flipping a coin for every pair
+        std::geometric_distribution<size_t> gap(p);
+        for (size_t start = t * chunk; start < std::min(n, (t + 1) * chunk); ++start){
+            // The n - 1 possible ends of start, skipping start itself
+            for (size_t end = gap(rng); end < n - 1; end += 1 + gap(rng)){
+                emit(V(start), V(end < start ? end : end + 1), weight(rng));
+            }
+        }
+    });
+}
+
+template <typename V, typename W>
+BasicGraphCSR<V, W> *ParallelGraphGenerator<V, W>::rmat(size_t scale, size_t edgeFactor, double a, double b, double c) const {
+    if (scale == 0 or scale >= 8 * sizeof(V)){
+        throw std::invalid_argument("Scale must be at least 1 and less than the bits of the vertex type");
+    }
+    if (a < 0 or b < 0 or c < 0 or a + b + c > 1){
+        throw std::invalid_argument("Quadrant probabilities must be between 0 and 1");
+    }
+    size_t n = size_t(1) << scale;
+    size_t m = edgeFactor * n;
+    return build(n, [this, scale, m, a, b, c](size_t t, auto emit){
+        std::mt19937_64 rng(seed_ + t);
+        std::uniform_int_distribution<W> weight(1, maxWeight_);
+        std::uniform_real_distribution<double> quadrant(0, 1);
+        size_t edges = m / threads_ + (t < m % threads_);
+        for (size_t edge_i = 0; edge_i < edges; ++edge_i){
+            size_t start = 0, end = 0;
+            for (size_t bit = 0; bit < scale; ++bit){
+                double r = quadrant(rng);
+                // a: top left, b: top right, c: bottom left, rest: bottom right
+                start = start << 1 | (r >= a + b);
+                end = end << 1 | ((r >= a and r < a + b) or r >= a + b + c);
+            }
+            if (start != end){
+                emit(V(start), V(end), weight(rng));
+            }
+        }
+    });
+}
+
+template <typename V, typename W>
+BasicGraphCSR<V, W> *ParallelGraphGenerator<V, W>::grid(size_t rows, size_t cols) const {
+    size_t n = rows * cols;
+    size_t chunk = (n + threads_ - 1) / threads_;
+    return build(n, [this, rows, cols, n, chunk](size_t t, auto emit){
+        std::mt19937_64 rng(seed_ + t);
+        std::uniform_int_distribution<W> weight(1, maxWeight_);
+        for (size_t vertex = t * chunk; vertex < std::min(n, (t + 1) * chunk); ++vertex){
+            size_t row = vertex / cols, col = vertex % cols;
+            if (row > 0){
+                emit(V(vertex), V(vertex - cols), weight(rng));
+            }
+            if (row + 1 < rows){
+                emit(V(vertex), V(vertex + cols), weight(rng));
+            }
+            if (col > 0){
+                emit(V(vertex), V(vertex - 1), weight(rng));
+            }
+            if (col + 1 < cols){
+                emit(V(vertex), V(vertex + 1), weight(rng));
+            }
+        }
+    });
+}
+
+template class ParallelGraphGenerator<uint16_t, uint16_t>;
+template class ParallelGraphGenerator<uint32_t, uint32_t>;
@@ -0,0 +1,184 @@
+// Benchmark concurrent priority queues: MultiQueue against one mutex around a
+// binary heap, in a push/pop throughput test and a parallel best-first search
+#include <vector>
+#include <string>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include "graph.hpp"
+#include "largeGraphs.hpp"
+
+#include "heap/d-ary.hpp"
+#include "heap/multi-queue.hpp"
+#include "interfaces.hpp"
+#include "adaptors.hpp"
+
+#include "dijkstra.hpp"
+#include "benchmark.hpp"
+
+namespace mq {
+
+constexpr size_t PREFILL = 1 << 20;
+constexpr size_t OPERATIONS = 1 << 22; // Pops and pushes, shared by the threads
+
+struct QueueResult {
+    std::string queue_;
+    std::string test_;
+    size_t threads_;
+    double time_; // milliseconds
+    double opsPerSecond_;
+    size_t pops_; // Search only: pops, more than vertices when pops are out of order
+
+    std::string to_string() const {
+        return BenchmarkLib::csvRow(queue_, test_, threads_, time_, opsPerSecond_, pops_);
+    }
+};
+
+// Runs f(t) on threads 0 to threads - 1 and waits for them
+template <typename F>
+void onThreads(size_t threads, F f){
+    std::vector<std::thread> team;
+    for (size_t t = 0; t < threads; ++t){
+        team.emplace_back(f, t);
+    }
+    for (std::thread &thread : team){
+        thread.join();
+    }
+}
+
+// Hold model: every thread pops an item and pushes a new one a little later
+// in priority order, so the queue keeps its size. Items are unique ids, as
+// the indexed binary heap needs.
+template <typename queue_t>
+QueueResult throughput(std::string name, size_t threads, queue_t &q){
+    std::mt19937_64 rng(1);
+    for (size_t i = 0; i < PREFILL; ++i){
+        q.push(i, rng() % PREFILL);
+    }
+    double time = BenchmarkLib::measureMs([&](){
+        onThreads(threads, [&q, threads](size_t t){
+            std::mt19937_64 rng(t + 2);
+            uint64_t nextId = uint64_t(t + 1) << 40;
+            for (size_t op = 0; op < OPERATIONS / threads / 2; ++op){
+                auto top = q.tryPop();
+                q.push(nextId++, (top ? top->second : 0) + 1 + rng() % 100);
+            }
+        });
+    });
+    return QueueResult{name, "Hold", threads, time, OPERATIONS / time * 1000, 0};
+}
+
+/**
+ * @brief Label correcting search from vertex 0 on a shared queue. Items are
+ * (distance << 32 | vertex), so they are unique and order by distance. A
+ * vertex is expanded again whenever it was popped before its final distance.
+ */
+template <typename queue_t>
+std::vector<uint32_t> parallelSearch(const LargeGraphCSR *g, size_t threads, queue_t &q, size_t &pops){
+    size_t n = g->getNumVertices();
+    std::vector<std::atomic<uint32_t>> dist(n);
+    for (std::atomic<uint32_t> &d : dist){
+        d.store(std::numeric_limits<uint32_t>::max(), std::memory_order_relaxed);
+    }
+    std::atomic<size_t> pending{1}; // Items pushed and not yet fully expanded
+    std::atomic<size_t> popCount{0};
+    dist[0].store(0);
+    q.push(0, 0);
+
+    onThreads(threads, [&](size_t){
+        size_t localPops = 0;
+        while (pending.load(std::memory_order_acquire)){
+            auto top = q.tryPop();
+            if (!top){
+                std::this_thread::yield();
+                continue;
+            }
+            ++localPops;
+            uint32_t vertex = uint32_t(top->first);
+            uint64_t d = top->first >> 32;
+            if (d == dist[vertex].load(std::memory_order_relaxed)){
+                for (const LargeEdge &e : g->edges(vertex)){
+                    uint64_t offer = d + e.weight;
+                    uint32_t seen = dist[e.outgoing].load(std::memory_order_relaxed);
+                    while (offer < seen){
+                        if (dist[e.outgoing].compare_exchange_weak(seen, uint32_t(offer), std::memory_order_relaxed)){
+                            pending.fetch_add(1, std::memory_order_relaxed);
+                            q.push(offer << 32 | e.outgoing, offer << 32 | e.outgoing);
+                            break;
+                        }
+                    }
+                }
+            }
+            pending.fetch_sub(1, std::memory_order_release);
+        }
+        popCount.fetch_add(localPops);
+    });
+    pops = popCount.load();
+
+    std::vector<uint32_t> paths(n);
+    for (size_t vertex = 0; vertex < n; ++vertex){
+        paths[vertex] = dist[vertex].load(std::memory_order_relaxed);
+    }
+    return paths;
+}
+
+template <typename queue_t>
+QueueResult search(std::string name, std::string graph, size_t threads, queue_t &q, const LargeGraphCSR *g,
+                   const std::vector<uint32_t> &reference){
+    std::vector<uint32_t> paths;
+    size_t pops = 0;
+    double time = BenchmarkLib::measureMs([&](){ paths = parallelSearch(g, threads, q, pops); });
+    if (paths != reference){
+        throw std::runtime_error(name + " found different distances on " + graph);
+    }
+    return QueueResult{name, "Search " + graph, threads, time, pops / time * 1000, pops};
+}
+
+}
+
+int main(){
+
+    // The binary heap keeps an index for changeKey, the unindexed one and the MultiQueue shards do not
+    using Locked = LockedHeap<BinaryMinHeap<uint64_t>>;
+    using LockedUnindexed = LockedHeap<UnindexedDAryHeap<uint64_t, uint64_t>>;
+    using Multi = MultiQueue<uint64_t, uint64_t>;
+
+    std::vector<mq::QueueResult> results;
+    std::cout << "queue, test, threads, time, opsPerSecond, pops" << std::endl;
+    auto report = [&results](mq::QueueResult r){
+        results.push_back(r);
+        std::cout << r.to_string() << std::endl;
+    };
+
+    for (size_t threads : BenchmarkLib::threadCounts()){
+        Locked locked;
+        report(mq::throughput("Locked Binary Heap", threads, locked));
+        LockedUnindexed unindexed;
+        report(mq::throughput("Locked Unindexed Binary Heap", threads, unindexed));
+        Multi multi(threads);
+        report(mq::throughput("MultiQueue c = 2", threads, multi));
+    }
+
+    LargeGraphGenerator gen;
+    for (auto [graph, g] : std::vector<std::pair<std::string, LargeGraphCSR *>>{
+             {"Erdos-Renyi", gen.erdosRenyi(1 << 19, 8)}, {"Grid", gen.grid(724, 724)}}){
+        std::vector<uint32_t> reference = dijkstra<IndexedDAryHeap<uint32_t, uint32_t, 4>, LargeGraphCSR>(g);
+        for (size_t threads : BenchmarkLib::threadCounts()){
+            Locked locked;
+            report(mq::search("Locked Binary Heap", graph, threads, locked, g, reference));
+            LockedUnindexed unindexed;
+            report(mq::search("Locked Unindexed Binary Heap", graph, threads, unindexed, g, reference));
+            Multi multi(threads);
+            report(mq::search("MultiQueue c = 2", graph, threads, multi, g, reference));
+        }
+        delete g;
+    }
+
+    BenchmarkLib::writeCSV("multi-queue.csv", "queue,test,threads,time,opsPerSecond,pops", results);
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Benchmark heaps with point to point queries: Dijkstra, bidirectional
+// Dijkstra and A* with landmarks, all stopping once the target is settled.
+#include <vector>
+#include <string>
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "graph.hpp"
+#include "randomGraphs.hpp"
+
+#include "heap/d-ary.hpp"
+#include "heap/binomial.hpp"
+#include "heap/fibonacci.hpp"
+#include "heap/pairing.hpp"
+#include "heap/radix.hpp"
+#include "interfaces.hpp"
+
+#include "point-to-point.hpp"
+#include "benchmark.hpp"
+
+namespace p2p {
+
+using namespace PointToPoint;
+
+constexpr size_t LANDMARKS = 4;
+
+// A graph with its random queries and their answers
+struct Workload {
+    const Graph *g_;
+    const Graph *reverse_;
+    LandmarkHeuristic landmarks_;
+    std::vector<std::pair<uint16_t, uint16_t>> queries_;
+    std::vector<uint32_t> answers_;
+    double sparsity_;
+};
+
+struct QueryResults {
+    std::string heap_;
+    std::string search_;
+    size_t n_;
+    double sparsity_;
+    size_t queries_;
+    double reached_; // Vertices given a distance per query, both directions
+    double meanTime_; // microseconds
+    double p99Time_; // microseconds
+    double queriesPerSecond_;
+
+    std::string to_string() const {
+        return BenchmarkLib::csvRow(heap_, search_, n_, sparsity_, queries_, reached_, meanTime_, p99Time_,
+                                    queriesPerSecond_);
+    }
+};
+
+// search(source, target, forward, backward) answers one query
+template <typename S>
+QueryResults runQueries(std::string heap, std::string search, const Workload &w, S query){
+    size_t n = w.g_->getNumVertices();
+    Distances forward(n), backward(n);
+    std::vector<double> times;
+    times.reserve(w.queries_.size());
+    size_t reached = 0;
+    for (size_t query_i = 0; query_i < w.queries_.size(); ++query_i){
+        auto [source, target] = w.queries_[query_i];
+        uint32_t dist = 0;
+        times.push_back(BenchmarkLib::measureMs([&](){ dist = query(source, target, forward, backward); }) * 1000);
+        if (dist != w.answers_[query_i]){
+            throw std::runtime_error(heap + " " + search + " found a different distance");
+        }
+        reached += forward.reached() + backward.reached();
+        forward.reset();
+        backward.reset();
+    }
+    double total = std::accumulate(times.begin(), times.end(), 0.0);
+    std::ranges::sort(times);
+    double p99 = times[times.size() * 99 / 100];
+    return QueryResults{heap, search, n, w.sparsity_, times.size(), double(reached) / times.size(),
+                        total / times.size(), p99, times.size() / total * 1e6};
+}
+
+template <Heap heap_t>
+void addHeap(std::vector<QueryResults>& results, std::string name, const Workload &w){
+    results.push_back(runQueries(name, "Dijkstra", w, [&w](uint16_t s, uint16_t t, Distances &forward, Distances &){
+        return aStar<heap_t>(w.g_, s, t, ZeroHeuristic{}, forward);
+    }));
+    results.push_back(runQueries(name, "Bidirectional Dijkstra", w, [&w](uint16_t s, uint16_t t, Distances &forward, Distances &backward){
+        return bidirectionalDijkstra<heap_t>(w.g_, w.reverse_, s, t, forward, backward);
+    }));
+    results.push_back(runQueries(name, "A* Landmarks", w, [&w](uint16_t s, uint16_t t, Distances &forward, Distances &){
+        return aStar<heap_t>(w.g_, s, t, w.landmarks_, forward);
+    }));
+    for (size_t result_i = results.size() - 3; result_i < results.size(); ++result_i){
+        std::cout << results[result_i].to_string() << std::endl;
+    }
+}
+
+void compareHeaps(std::vector<QueryResults>& results, double sparsity, size_t n, size_t numQueries){
+    RandomGraphGenerator gen(sparsity, n);
+    GraphAdjList *g = gen.makeGraph();
+    GraphAdjList *reverse = reverseGraph(g);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint16_t> vertex(0, uint16_t(n - 1));
+    Workload w{g, reverse, LandmarkHeuristic::build<IndexedDAryHeap<uint16_t, uint32_t, 4>>(g, reverse, LANDMARKS, vertex(rng)),
+               {}, {}, sparsity};
+    Distances dist(n);
+    for (size_t query_i = 0; query_i < numQueries; ++query_i){
+        w.queries_.push_back({vertex(rng), vertex(rng)});
+        w.answers_.push_back(aStar<BinaryMinHeap<uint32_t>>(g, w.queries_.back().first, w.queries_.back().second, ZeroHeuristic{}, dist));
+        dist.reset();
+    }
+
+    addHeap<DAryHeap<uint16_t, uint32_t, 2>>(results, "Binary Heap", w);
+    addHeap<DAryHeap<uint16_t, uint32_t, 4>>(results, "DAry Heap D = 4", w);
+    addHeap<IndexedDAryHeap<uint16_t, uint32_t, 2>>(results, "Indexed Binary Heap", w);
+    addHeap<IndexedDAryHeap<uint16_t, uint32_t, 4>>(results, "Indexed DAry Heap D = 4", w);
+    addHeap<PairingHeap<uint16_t, uint32_t, std::less<uint32_t>>>(results, "Pairing Heap", w);
+    addHeap<IndexedBinomialHeap<uint16_t, uint32_t>>(results, "Indexed Binomial Heap", w);
+    addHeap<IndexedFibonacciHeap<uint16_t, uint32_t>>(results, "Indexed Fibonacci Heap", w);
+    addHeap<RadixHeap<uint16_t, uint32_t>>(results, "Radix Heap", w);
+    addHeap<IndexedRadixHeap<uint16_t, uint32_t>>(results, "Indexed Radix Heap", w);
+
+    delete reverse;
+    delete g;
+}
+
+}
+
+int main(int argc, char** argv) {
+
+    // Latency mode times a few hundred queries per graph, throughput mode thousands
+    bool throughput = argc > 1 and std::string(argv[1]) == "throughput";
+    size_t numQueries = throughput ? 5000 : 200;
+    if (argc > 2){
+        numQueries = strtoul(argv[2], nullptr, 10);
+    }
+    if (argc > 3 or numQueries == 0 or (argc > 1 and !throughput and std::string(argv[1]) != "latency")){
+        std::cout << "usage: " << argv[0] << " [latency|throughput] [queries per graph]\n";
+        return -1;
+    }
+
+    std::vector<p2p::QueryResults> results;
+    std::cout << "heap, search, n, sparsity, queries, reached, meanTime, p99Time, queriesPerSecond" << std::endl;
+    for (auto [sparsity, n] : std::vector<std::pair<double, size_t>>{{0.0005, 20000}, {0.005, 20000}, {0.0002, 60000}}){
+        p2p::compareHeaps(results, sparsity, n, numQueries);
+    }
+
+    BenchmarkLib::writeCSV(throughput ? "point-to-point-throughput.csv" : "point-to-point.csv",
+                           "heap,search,n,sparsity,queries,reached,meanTime,p99Time,queriesPerSecond", results);
+    return 0;
+}
@@ -0,0 +1,420 @@
+#include "bucket-cuckoo-hash.hpp"
+#include <iostream>
+#include <sstream>
+#include <utility>
+#include <bit>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+
+/**************************
+ * Bucket Cuckoo Hash Map *
+ **************************/
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::BucketCuckooHashMap():
+    epsilon_{0.4},
+    size_{0},
+    maxLoop_{1},
+    numBuckets_{1},
+    downsizeThresh_{0.2}
+    {
+        allocate(1);
+    }
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::BucketCuckooHashMap(double epsilon, float downsizeThresh):
+    epsilon_{epsilon},
+    size_{0},
+    maxLoop_{1},
+    numBuckets_{1},
+    downsizeThresh_{downsizeThresh}
+    {
+        allocate(1);
+    }
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::~BucketCuckooHashMap(){
+    deallocate();
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::allocate(size_t numBuckets){
+    numBuckets_ = numBuckets;
+    table1_ = new Bucket[numBuckets_];
+    table2_ = new Bucket[numBuckets_];
+    values1_ = new value_t[numBuckets_ * SlotsPerBucket];
+    values2_ = new value_t[numBuckets_ * SlotsPerBucket];
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::deallocate(){
+    delete[] table1_;
+    delete[] table2_;
+    delete[] values1_;
+    delete[] values2_;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+value_t& BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::valueAt(const Bucket* bucket, size_t slot) const {
+    // std::less orders pointers into different arrays
+    bool inTable2 = !std::less<const Bucket*>{}(bucket, table2_) and std::less<const Bucket*>{}(bucket, table2_ + numBuckets_);
+    const Bucket *table = inTable2 ? table2_ : table1_;
+    value_t *values = inTable2 ? values2_ : values1_;
+    return values[(bucket - table) * SlotsPerBucket + slot];
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+size_t BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::getHash1(const key_t& key) const {
+    return hash_.hash1(key);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+size_t BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::getHash2(size_t hash1) const {
+    return hash_.hash2(hash1);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+uint8_t BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::getTag(size_t hash2) {
+    // The top byte of hash2 is not used to pick a bucket. Tag 0 marks an empty slot.
+    uint8_t tag = uint8_t(uint64_t(hash2) >> 56);
+    return tag == EMPTY_TAG ? 1 : tag;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::updateMaxLoop(){
+    // Same bound as the one slot table, a chain has SlotsPerBucket choices at each step
+    maxLoop_ = 3*size_t(ceil(log(size_ + 1) / log(1 + epsilon_))) + 1;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+double BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::loadFactor() const{
+    return double(size_) / (2 * numBuckets_ * SlotsPerBucket);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::empty() const{
+    return size_ == 0;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+size_t BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::size() const{
+    return size_;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::clear(){
+    deallocate();
+    allocate(1);
+    maxLoop_ = 1;
+    size_ = 0;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::rehash(size_t numBuckets){
+    std::vector<std::pair<key_t, value_t>> allItems;
+    allItems.reserve(size_);
+    for (Bucket *table : {table1_, table2_}){
+        for (Bucket *bucket = table; bucket < table + numBuckets_; ++bucket){
+            for (size_t slot = 0; slot < SlotsPerBucket; ++slot){
+                if (bucket->valid(slot)){
+                    allItems.emplace_back(std::move(bucket->keys_[slot]), std::move(valueAt(bucket, slot)));
+                }
+            }
+        }
+    }
+    deallocate();
+
+    // Rehash into new table;
+    allocate(numBuckets);
+    for (auto &[key, value] : allItems)
+    {
+        insert(std::move(key), std::move(value), false);
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::find(const key_t& key, Bucket*& bucket, size_t& slot) const {
+    size_t hash1 = getHash1(key);
+    size_t hash2 = getHash2(hash1);
+    uint8_t tag = getTag(hash2);
+    for (Bucket *candidate : {&table1_[hash1 % numBuckets_], &table2_[hash2 % numBuckets_]}){
+        bucket = candidate;
+        if (findInBucket(key, tag, bucket, slot)){
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::findInBucket(const key_t& key, uint8_t tag, Bucket* bucket, size_t& slot) const {
+    // Only compare keys in slots with a matching tag
+    for (uint32_t matches = bucket->match(tag); matches != 0; matches &= matches - 1){
+        slot = std::countr_zero(matches);
+        if (bucket->keys_[slot] == key){
+            return true;
+        }
+    }
+    slot = SlotsPerBucket;
+    return false;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::contains(const key_t& key) const {
+    Bucket *bucket;
+    size_t slot;
+    return find(key, bucket, slot);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::insert(key_t key, value_t value, bool updateValues){
+    if (updateValues and contains(key)) {
+        return;
+    }
+    for (size_t loops = 0; loops < maxLoop_; ++loops){
+        size_t h1 = getHash1(key);
+        size_t h2 = getHash2(h1);
+        uint8_t tag = getTag(h2);
+        Bucket &bucket1 = table1_[h1 % numBuckets_];
+        Bucket &bucket2 = table2_[h2 % numBuckets_];
+
+        // Either bucket has an empty slot, insert and finish
+        for (Bucket *bucket : {&bucket1, &bucket2}){
+            if (!bucket->full()){
+                size_t slot = bucket->freeSlot();
+                bucket->tags_[slot] = tag;
+                bucket->keys_[slot] = std::move(key);
+                valueAt(bucket, slot) = std::move(value);
+                if (updateValues){
+                    ++size_;
+                    updateMaxLoop();
+                }
+                return;
+            }
+        }
+
+        // Both buckets are full: evict a random slot, alternating tables so the
+        // evicted item moves to its other bucket on the next loop.
+        Bucket &victim = (loops % 2 == 0) ? bucket1 : bucket2;
+        size_t slot = rng_() % SlotsPerBucket;
+        victim.tags_[slot] = tag;
+        std::swap(key, victim.keys_[slot]);
+        std::swap(value, valueAt(&victim, slot));
+    }
+    // Rehash and insert the evicted item.
+    rehash(numBuckets_ * 2);
+    insert(std::move(key), std::move(value), updateValues);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::insert(const key_t& key, const value_t& value){
+    insert(key, value, true);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::erase(const key_t& key){
+    Bucket *bucket;
+    size_t slot;
+    if (find(key, bucket, slot)){
+        bucket->tags_[slot] = EMPTY_TAG;
+        --size_;
+        updateMaxLoop();
+
+        // Check if resizing is needed.
+        if (numBuckets_ > 1 and downsizeThresh_ > loadFactor())
+        {
+            rehash(numBuckets_ / 2);
+        }
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+value_t& BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::lookup(const key_t& key) const {
+    // Assume that contains has been called
+    Bucket *bucket;
+    size_t slot;
+    find(key, bucket, slot);
+    // If the key is not in the table, this is wrong!
+    return valueAt(bucket, slot % SlotsPerBucket);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+template <typename F>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::probeBatch(std::span<const key_t> keys, F found) const {
+    Bucket *bucket1[BATCH_SIZE];
+    Bucket *bucket2[BATCH_SIZE];
+    uint8_t tags[BATCH_SIZE];
+    for (size_t start = 0; start < keys.size(); start += BATCH_SIZE){
+        size_t count = std::min(BATCH_SIZE, keys.size() - start);
+        // Hash every key first so the loads of all candidate buckets are in flight together
+        for (size_t i = 0; i < count; ++i){
+            size_t hash1 = getHash1(keys[start + i]);
+            size_t hash2 = getHash2(hash1);
+            tags[i] = getTag(hash2);
+            bucket1[i] = table1_ + hash1 % numBuckets_;
+            bucket2[i] = table2_ + hash2 % numBuckets_;
+            // Only the tags and keys, a value is read once its key matched
+            __builtin_prefetch(bucket1[i]);
+            __builtin_prefetch(bucket2[i]);
+        }
+        for (size_t i = 0; i < count; ++i){
+            const key_t &key = keys[start + i];
+            size_t slot;
+            if (findInBucket(key, tags[i], bucket1[i], slot)){
+                found(start + i, &values1_[(bucket1[i] - table1_) * SlotsPerBucket + slot]);
+            } else if (findInBucket(key, tags[i], bucket2[i], slot)){
+                found(start + i, &values2_[(bucket2[i] - table2_) * SlotsPerBucket + slot]);
+            } else {
+                found(start + i, nullptr);
+            }
+        }
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::containsBatch(std::span<const key_t> keys, std::span<bool> found) const {
+    if (found.size() < keys.size()){
+        throw std::invalid_argument("containsBatch needs an output for every key");
+    }
+    probeBatch(keys, [&found](size_t i, value_t *value){ found[i] = value != nullptr; });
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::lookupBatch(std::span<const key_t> keys, std::span<value_t*> values) const {
+    if (values.size() < keys.size()){
+        throw std::invalid_argument("lookupBatch needs an output for every key");
+    }
+    probeBatch(keys, [&values](size_t i, value_t *value){ values[i] = value; });
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+value_t& BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::operator[](const key_t& key) {
+    return lookup(key);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::printToStream(std::ostream& out) const {
+    for (size_t t = 0; t < 2; ++t){
+        Bucket *table = (t == 0) ? table1_ : table2_;
+        out << "Table " << t + 1 << ": [ ";
+        for (Bucket *bucket = table; bucket < table + numBuckets_; ++bucket){
+            out << "{ ";
+            for (size_t slot = 0; slot < SlotsPerBucket; ++slot){
+                if (bucket->valid(slot)){
+                    out << "(" << bucket->keys_[slot] << ": " << valueAt(bucket, slot) << ") ";
+                } else {
+                    out << "(-:-) ";
+                }
+            }
+            out << "} ";
+        }
+        out << "]\n";
+    }
+    out << " Epsilon: " << epsilon_ << " Num Buckets: " << numBuckets_ << " Slots Per Bucket: " << SlotsPerBucket << " Size: " << size_ << " Max Loops: " << maxLoop_;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+std::string BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::to_string() const {
+    std::stringstream ss;
+    printToStream(ss);
+    return ss.str();
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+std::ostream& operator<<(std::ostream& os, const BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>& ch){
+    os << ch.to_string();
+    return os;
+}
+
+// Bucket Functions
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::Bucket::Bucket():tags_{}{}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+uint32_t BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::Bucket::match(uint8_t tag) const {
+#if defined(__SSE2__)
+    __m128i tags = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(tags_));
+    uint32_t matches = _mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8(char(tag))));
+#else
+    uint32_t matches = 0;
+    for (size_t slot = 0; slot < SlotsPerBucket; ++slot){
+        matches |= uint32_t(tags_[slot] == tag) << slot;
+    }
+#endif
+    return matches & FULL_MASK;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::Bucket::full() const {
+    return match(EMPTY_TAG) == 0;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::Bucket::valid(size_t slot) const {
+    return tags_[slot] != EMPTY_TAG;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+size_t BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::Bucket::freeSlot() const {
+    return std::countr_zero(match(EMPTY_TAG));
+}
+
+// Iterator Functions
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+typename BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConstIterator BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::begin() const {
+    return ConstIterator(0, this);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+typename BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConstIterator BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::end() const {
+    return ConstIterator(2 * numBuckets_ * SlotsPerBucket, this);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConstIterator::ConstIterator(size_t idx, const BucketCuckooHashMap *map):
+    map_{map}, idx_{idx}, tableSize_{map->numBuckets_ * SlotsPerBucket}{
+    iterateTable();
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+typename BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConstIterator& BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConstIterator::operator++() {
+    ++idx_;
+    iterateTable();
+    return *this;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+const typename BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::Bucket& BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConstIterator::bucket() const {
+    if (idx_ < tableSize_){
+        return map_->table1_[idx_ / SlotsPerBucket];
+    } else {
+        return map_->table2_[(idx_ - tableSize_) / SlotsPerBucket];
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConstIterator::iterateTable(){
+    while (idx_ < 2 * tableSize_ and !bucket().valid(idx_ % SlotsPerBucket)){
+        ++idx_;
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+typename BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConstIterator::value_type BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConstIterator::operator*() const{
+    const Bucket &b = bucket();
+    size_t slot = idx_ % SlotsPerBucket;
+    return {b.keys_[slot], map_->valueAt(&b, slot)};
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConstIterator::operator==(const ConstIterator& other) const {
+    return (idx_ == other.idx_) and (map_ == other.map_);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConstIterator::operator!=(const ConstIterator& other) const{
+    return !(*this == other);
+}
@@ -0,0 +1,185 @@
+/**
+ * @file bucket-cuckoo-hash.hpp
+ * @brief Bucketized (set-associative) Cuckoo Hash Map. Each bucket holds
+ * several slots, their tags and keys packed together, so the table can run at
+ * a much higher load factor than the one slot per bucket CuckooHashMap.
+ * @note Keys and Values must be default constructible and movable
+ *
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <iterator>
+#include <tuple>
+#include <span>
+#include <functional>
+
+#include "cuckoo-hash-policy.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifndef BUCKET_CUCKOO_HASH_HPP_INCLUDED
+#define BUCKET_CUCKOO_HASH_HPP_INCLUDED
+
+/**
+ * @brief Cuckoo Hash Map where each of the two candidate locations of a key is
+ * a bucket of SlotsPerBucket slots. A lookup probes at most two buckets and
+ * filters their slots with one SSE2 compare of 8 bit tags before comparing keys.
+ *
+ * A bucket holds only tags and keys, values are kept in a separate array. When
+ * ONE_LINE_BUCKETS holds (8 + SlotsPerBucket * sizeof(key_t) <= 64, e.g. 8 int
+ * or 4 uint64_t keys) a lookup reads at most two cache lines, plus the line of
+ * the value it finds. Larger keys spill a bucket over several lines, but the
+ * tags always sit in the first one.
+ *
+ * @tparam key_t Key type
+ * @tparam value_t Value type
+ * @tparam SlotsPerBucket Number of slots in a bucket. Between 1 and 8.
+ * @tparam Hash Hash policy, see cuckoo-hash-policy.hpp
+ */
+template <typename key_t, typename value_t, size_t SlotsPerBucket = 4, typename Hash = MixHashPolicy<key_t>>
+class BucketCuckooHashMap
+{
+    static_assert(SlotsPerBucket > 0 and SlotsPerBucket <= 8, "Bucket tags are loaded as one 8 byte word");
+    static_assert(CuckooHashPolicy<Hash, key_t>, "Hash must provide hash1(key) and hash2(hash1)");
+
+  private:
+    class ConstIterator;
+
+    // Each slot has an 8 bit tag derived from the hash of its key. A probe
+    // compares all tags of a bucket at once and only reads keys whose tag matches.
+    // The value of slot i of bucket b is at values[b * SlotsPerBucket + i] of the same table.
+    struct alignas(64) Bucket {
+        uint8_t tags_[8]; // EMPTY_TAG if the slot is free. Always 8 wide for one 64 bit load
+        key_t keys_[SlotsPerBucket];
+
+        Bucket();
+        uint32_t match(uint8_t tag) const; // Bit i is set if slot i has this tag
+        bool full() const;
+        bool valid(size_t slot) const;
+        size_t freeSlot() const; // Precondition: !full()
+    };
+
+    static constexpr uint32_t FULL_MASK = (1u << SlotsPerBucket) - 1;
+    static constexpr uint8_t EMPTY_TAG = 0;
+
+    // Data
+    Bucket* table1_;
+    Bucket* table2_;
+    value_t* values1_; // numBuckets_ * SlotsPerBucket values of table1_
+    value_t* values2_;
+    double epsilon_;
+    size_t size_;
+    size_t maxLoop_; // set to 3 log_1+e(n)
+    size_t numBuckets_;
+    Hash hash_;
+    float downsizeThresh_;
+    std::minstd_rand rng_; // Chooses which slot of a full bucket is evicted
+
+    // Helper Functions
+    size_t getHash1(const key_t& key) const;
+    size_t getHash2(size_t hash1) const;
+    static uint8_t getTag(size_t hash2);
+    void updateMaxLoop();
+    void rehash(size_t numBuckets);
+    void insert(key_t key, value_t value, bool updateValues);
+    bool find(const key_t &key, Bucket *&bucket, size_t &slot) const;
+    bool findInBucket(const key_t &key, uint8_t tag, Bucket *bucket, size_t &slot) const;
+    value_t &valueAt(const Bucket *bucket, size_t slot) const; // bucket is in table1_ or table2_
+    void allocate(size_t numBuckets);
+    void deallocate();
+    void printToStream(std::ostream &os) const;
+
+    // Number of keys hashed and prefetched before any of them are probed
+    static constexpr size_t BATCH_SIZE = 16;
+
+    // Calls found(i, value) for each key, value is nullptr if keys[i] is not in the table
+    template <typename F>
+    void probeBatch(std::span<const key_t> keys, F found) const;
+
+  public:
+
+    // A bucket's tags and keys fit in one cache line
+    static constexpr bool ONE_LINE_BUCKETS = sizeof(Bucket) == 64;
+
+    // Type Names:
+    using value_type = std::pair<key_t, value_t>;
+    using key_type = key_t;
+    using mapped_type = value_t;
+    using const_iterator = ConstIterator;
+
+    // Constructors
+    BucketCuckooHashMap();
+    BucketCuckooHashMap(double epsilon, float downsizeThresh);
+    ~BucketCuckooHashMap();
+    BucketCuckooHashMap(const BucketCuckooHashMap &other) = delete;
+    BucketCuckooHashMap &operator=(const BucketCuckooHashMap &other) = delete;
+
+    // Modification and Lookup;
+    bool contains(const key_t &key) const;
+    void insert(const key_t& key, const value_t& value);
+    void erase(const key_t& key);
+    value_t &lookup(const key_t& key) const;
+    void clear();
+
+    // Batched Lookup. Hides memory latency by prefetching the buckets of many keys at once
+    void containsBatch(std::span<const key_t> keys, std::span<bool> found) const;
+    void lookupBatch(std::span<const key_t> keys, std::span<value_t*> values) const; // nullptr if not found
+
+    // Data Lookup
+    bool empty() const;
+    size_t size() const;
+    double loadFactor() const;
+    std::string to_string() const;
+    // Iterator Functions
+    ConstIterator begin() const;
+    ConstIterator end() const;
+
+    value_t &operator[](const key_t& key);
+
+  private:
+    class ConstIterator {
+        friend class BucketCuckooHashMap;
+
+  private:
+        const BucketCuckooHashMap *map_;
+        size_t idx_; // Slot index over both tables
+        size_t tableSize_; // numBuckets_ * SlotsPerBucket
+
+        /**
+         * @brief Iterates over a table until a new idx is found.
+         */
+        void iterateTable();
+        const Bucket &bucket() const;
+
+  public:
+        using value_type = std::tuple<key_t, value_t>;
+        using reference = const value_type&;
+        using pointer = const value_type*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        ConstIterator() = default;
+        ConstIterator(size_t idx, const BucketCuckooHashMap *map);
+        ConstIterator(const ConstIterator &other) = default;
+        ConstIterator &operator=(const ConstIterator &other) = default;
+        ~ConstIterator() = default;
+
+        value_type operator*() const;
+        ConstIterator &operator++();
+        bool operator==(const ConstIterator &other) const;
+        bool operator!=(const ConstIterator &other) const;
+    };
+};
+
+template<typename key_t,typename value_t, size_t SlotsPerBucket, typename Hash>
+std::ostream &operator<<(std::ostream& os, const BucketCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash> &ch );
+
+#include "bucket-cuckoo-hash-private.hpp"
+
+#endif // BUCKET_CUCKOO_HASH_HPP_INCLUDED
@@ -0,0 +1,461 @@
+#include "concurrent-cuckoo-hash.hpp"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+/******************************
+ * Concurrent Cuckoo Hash Map *
+ ******************************/
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConcurrentCuckooHashMap():
+    ConcurrentCuckooHashMap(1024, 5)
+    {
+        // Nothing here
+    }
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ConcurrentCuckooHashMap(size_t initialBuckets, size_t maxPathDepth):
+    initialBuckets_{std::bit_ceil(std::max<size_t>(initialBuckets, 1))},
+    maxPathDepth_{maxPathDepth},
+    size_{0}
+    {
+        // The table never has fewer buckets than stripes, so a bucket's stripe
+        // only depends on its hash and not on the size of the table.
+        numStripes_ = std::min(initialBuckets_, MAX_STRIPES);
+        stripes_ = std::make_unique<Stripe[]>(numStripes_);
+        readers_ = std::make_unique<ReaderCount[]>(READER_COUNTS);
+        numRetired_.store(0);
+        current_ = std::make_unique<Table>(initialBuckets_);
+        table_.store(current_.get());
+    }
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+size_t ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::getHash1(const key_t& key) const {
+    return hash_.hash1(key);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+uint8_t ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::getTag(size_t hash1) const {
+    uint8_t tag = uint8_t(uint64_t(hash_.hash2(hash1)) >> 56);
+    return tag == EMPTY_TAG ? 1 : tag;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+size_t ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::altBucket(size_t bucket, uint8_t tag) {
+    // XOR is its own inverse, so altBucket(altBucket(b, tag), tag) == b.
+    // Callers mask the result with the size of their table.
+    return bucket ^ (size_t(tag) * 0x5BD1E995);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+uint8_t ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::loadTag(const Bucket& bucket, size_t slot) {
+    // Tags are read without holding the stripe lock by the path search and optimistic readers
+    return std::atomic_ref<uint8_t>(const_cast<uint8_t&>(bucket.tags_[slot])).load(std::memory_order_relaxed);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::storeTag(Bucket& bucket, size_t slot, uint8_t tag) {
+    std::atomic_ref<uint8_t>(bucket.tags_[slot]).store(tag, std::memory_order_relaxed);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+size_t ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::stripe(size_t bucket) const {
+    return bucket & (numStripes_ - 1);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::lockPair(size_t stripe1, size_t stripe2) const {
+    // Always lock the lower stripe first so two writers can't deadlock
+    if (stripe1 > stripe2){
+        std::swap(stripe1, stripe2);
+    }
+    stripes_[stripe1].lock();
+    if (stripe2 != stripe1){
+        stripes_[stripe2].lock();
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::unlockPair(size_t stripe1, size_t stripe2) const {
+    stripes_[stripe1].unlock();
+    if (stripe2 != stripe1){
+        stripes_[stripe2].unlock();
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::lockAll() const {
+    for (size_t i = 0; i < numStripes_; ++i){
+        stripes_[i].lock();
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::unlockAll() const {
+    for (size_t i = 0; i < numStripes_; ++i){
+        stripes_[i].unlock();
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+size_t ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::readerSlot() {
+    thread_local size_t slot = std::hash<std::thread::id>{}(std::this_thread::get_id()) % READER_COUNTS;
+    return slot;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::replaceTable(std::unique_ptr<Table> table){
+    std::lock_guard lock(retiredMutex_);
+    table_.store(table.get(), std::memory_order_seq_cst);
+    retired_.push_back(std::move(current_));
+    current_ = std::move(table);
+    numRetired_.store(retired_.size(), std::memory_order_relaxed);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::reclaim() const {
+    // Whoever holds the lock is already reclaiming
+    std::unique_lock lock(retiredMutex_, std::try_to_lock);
+    if (!lock.owns_lock() or retired_.empty()){
+        return;
+    }
+    // A reader counted after its count is seen at zero loads table_ after it
+    // was replaced (both are seq_cst), so it cannot reach a retired table.
+    for (size_t i = 0; i < READER_COUNTS; ++i){
+        if (readers_[i].count_.load(std::memory_order_seq_cst) != 0){
+            return; // The last reader to leave tries again
+        }
+    }
+    retired_.clear();
+    numRetired_.store(0, std::memory_order_relaxed);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::findInTable(const Table& table, size_t hash1, uint8_t tag, const key_t& key, value_t* value) const {
+    size_t bucket1 = hash1 & table.mask_;
+    size_t bucket2 = altBucket(bucket1, tag) & table.mask_;
+    for (size_t b : {bucket1, bucket2}){
+        const Bucket &bucket = table.buckets_[b];
+        for (size_t slot = 0; slot < SlotsPerBucket; ++slot){
+            if (loadTag(bucket, slot) == tag and bucket.keys_[slot] == key){
+                if (value){
+                    *value = bucket.values_[slot];
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::search(const key_t& key, value_t* value) const {
+    size_t hash1 = getHash1(key);
+    uint8_t tag = getTag(hash1);
+    // The table has at least numStripes_ buckets, so the stripes can be found before loading the table
+    size_t stripe1 = stripe(hash1);
+    size_t stripe2 = stripe(altBucket(hash1, tag));
+
+    if constexpr (OPTIMISTIC_READS){
+        ReadGuard reading(*this);
+        while (true){
+            uint64_t version1 = stripes_[stripe1].version_.load(std::memory_order_acquire);
+            uint64_t version2 = stripes_[stripe2].version_.load(std::memory_order_acquire);
+            if ((version1 | version2) & 1){
+                // A writer holds one of the stripes
+                std::this_thread::yield();
+                continue;
+            }
+            value_t copy{};
+            bool found = findInTable(*table_.load(std::memory_order_seq_cst), hash1, tag, key, &copy);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (stripes_[stripe1].version_.load(std::memory_order_relaxed) == version1 and
+                stripes_[stripe2].version_.load(std::memory_order_relaxed) == version2){
+                if (found and value){
+                    *value = copy;
+                }
+                return found;
+            }
+        }
+    } else {
+        lockPair(stripe1, stripe2);
+        bool found = findInTable(*table_.load(std::memory_order_relaxed), hash1, tag, key, value);
+        unlockPair(stripe1, stripe2);
+        return found;
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::contains(const key_t& key) const {
+    return search(key, nullptr);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::find(const key_t& key, value_t& value) const {
+    return search(key, &value);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+value_t ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::lookup(const key_t& key) const {
+    value_t value;
+    if (!search(key, &value)){
+        throw std::out_of_range("Key is not in the map");
+    }
+    return value;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::insert(const key_t& key, const value_t& value){
+    size_t hash1 = getHash1(key);
+    uint8_t tag = getTag(hash1);
+    size_t stripe1 = stripe(hash1);
+    size_t stripe2 = stripe(altBucket(hash1, tag));
+
+    while (true){
+        // cuckooPath probes the table after its stripes are unlocked
+        ReadGuard reading(*this);
+        lockPair(stripe1, stripe2);
+        // Holding any stripe keeps the table from growing
+        Table *table = table_.load(std::memory_order_relaxed);
+        if (findInTable(*table, hash1, tag, key, nullptr)){
+            unlockPair(stripe1, stripe2);
+            return;
+        }
+        size_t bucket1 = hash1 & table->mask_;
+        size_t bucket2 = altBucket(bucket1, tag) & table->mask_;
+        for (size_t b : {bucket1, bucket2}){
+            Bucket &bucket = table->buckets_[b];
+            for (size_t slot = 0; slot < SlotsPerBucket; ++slot){
+                if (bucket.tags_[slot] == EMPTY_TAG){
+                    bucket.keys_[slot] = key;
+                    bucket.values_[slot] = value;
+                    storeTag(bucket, slot, tag);
+                    ++size_;
+                    unlockPair(stripe1, stripe2);
+                    return;
+                }
+            }
+        }
+        unlockPair(stripe1, stripe2);
+
+        // Both buckets are full. Make room by moving items along an eviction
+        // path, or grow the table if there is no path.
+        if (!cuckooPath(table, bucket1, bucket2)){
+            grow(table);
+        }
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::cuckooPath(Table* table, size_t bucket1, size_t bucket2){
+    // Breadth first search over buckets without holding any lock. The tags
+    // can change under the search, movePath checks every step before moving.
+    std::vector<PathNode> nodes{{bucket1, NO_PARENT, 0, 0}, {bucket2, NO_PARENT, 0, 0}};
+    for (size_t i = 0; i < nodes.size(); ++i){
+        PathNode node = nodes[i];
+        const Bucket &bucket = table->buckets_[node.bucket_];
+        uint8_t tags[SlotsPerBucket];
+        for (size_t slot = 0; slot < SlotsPerBucket; ++slot){
+            tags[slot] = loadTag(bucket, slot);
+            if (tags[slot] == EMPTY_TAG){
+                return movePath(table, nodes, i);
+            }
+        }
+        if (node.depth_ < maxPathDepth_){
+            for (size_t slot = 0; slot < SlotsPerBucket; ++slot){
+                nodes.push_back({altBucket(node.bucket_, tags[slot]) & table->mask_, i, slot, node.depth_ + 1});
+            }
+        }
+    }
+    return false;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::movePath(Table* table, const std::vector<PathNode>& nodes, size_t end){
+    // Move items starting from the end of the path, each step frees a slot for the one before it
+    for (size_t i = end; nodes[i].parent_ != NO_PARENT; i = nodes[i].parent_){
+        size_t from = nodes[nodes[i].parent_].bucket_;
+        size_t to = nodes[i].bucket_;
+        size_t fromSlot = nodes[i].slot_;
+        size_t fromStripe = stripe(from);
+        size_t toStripe = stripe(to);
+        lockPair(fromStripe, toStripe);
+
+        // Some other writer changed the path, give up and let insert try again
+        Bucket &source = table->buckets_[from];
+        Bucket &dest = table->buckets_[to];
+        uint8_t tag = source.tags_[fromSlot];
+        size_t toSlot = std::find(dest.tags_, dest.tags_ + SlotsPerBucket, EMPTY_TAG) - dest.tags_;
+        if (table_.load(std::memory_order_relaxed) != table or tag == EMPTY_TAG or
+            (altBucket(from, tag) & table->mask_) != to or toSlot == SlotsPerBucket){
+            unlockPair(fromStripe, toStripe);
+            return true;
+        }
+        dest.keys_[toSlot] = std::move(source.keys_[fromSlot]);
+        dest.values_[toSlot] = std::move(source.values_[fromSlot]);
+        storeTag(dest, toSlot, tag);
+        storeTag(source, fromSlot, EMPTY_TAG);
+        unlockPair(fromStripe, toStripe);
+    }
+    return true;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::insertUnlocked(Table& table, size_t hash1, uint8_t tag, key_t& key, value_t& value, size_t maxLoop){
+    // Random walk insert, only used while every stripe is locked
+    auto placed = [&](size_t b){
+        Bucket &bucket = table.buckets_[b];
+        size_t slot = std::find(bucket.tags_, bucket.tags_ + SlotsPerBucket, EMPTY_TAG) - bucket.tags_;
+        if (slot == SlotsPerBucket){
+            return false;
+        }
+        bucket.keys_[slot] = std::move(key);
+        bucket.values_[slot] = std::move(value);
+        bucket.tags_[slot] = tag;
+        return true;
+    };
+    size_t b = hash1 & table.mask_;
+    if (placed(b)){
+        return true;
+    }
+    b = altBucket(b, tag) & table.mask_;
+    for (size_t loops = 0; loops < maxLoop; ++loops){
+        if (placed(b)){
+            return true;
+        }
+        // Evict an item from b and carry it to its other bucket
+        size_t slot = loops % SlotsPerBucket;
+        Bucket &victim = table.buckets_[b];
+        std::swap(key, victim.keys_[slot]);
+        std::swap(value, victim.values_[slot]);
+        std::swap(tag, victim.tags_[slot]);
+        b = altBucket(b, tag) & table.mask_;
+    }
+    return false;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::grow(Table* table){
+    lockAll();
+    if (table_.load(std::memory_order_relaxed) != table){
+        // Another writer already grew the table
+        unlockAll();
+        return;
+    }
+    size_t numBuckets = 2 * (table->mask_ + 1);
+    while (true){
+        auto bigger = std::make_unique<Table>(numBuckets);
+        bool moved = true;
+        for (size_t b = 0; b <= table->mask_ and moved; ++b){
+            Bucket &bucket = table->buckets_[b];
+            for (size_t slot = 0; slot < SlotsPerBucket and moved; ++slot){
+                if (bucket.tags_[slot] != EMPTY_TAG){
+                    // Copies so the old table stays intact if this size fails
+                    key_t key = bucket.keys_[slot];
+                    value_t value = bucket.values_[slot];
+                    moved = insertUnlocked(*bigger, getHash1(key), bucket.tags_[slot], key, value, 500);
+                }
+            }
+        }
+        if (moved){
+            replaceTable(std::move(bigger));
+            break;
+        }
+        numBuckets *= 2;
+    }
+    unlockAll();
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::erase(const key_t& key){
+    size_t hash1 = getHash1(key);
+    uint8_t tag = getTag(hash1);
+    size_t stripe1 = stripe(hash1);
+    size_t stripe2 = stripe(altBucket(hash1, tag));
+    lockPair(stripe1, stripe2);
+    Table *table = table_.load(std::memory_order_relaxed);
+    size_t bucket1 = hash1 & table->mask_;
+    size_t bucket2 = altBucket(bucket1, tag) & table->mask_;
+    for (size_t b : {bucket1, bucket2}){
+        Bucket &bucket = table->buckets_[b];
+        for (size_t slot = 0; slot < SlotsPerBucket; ++slot){
+            if (bucket.tags_[slot] == tag and bucket.keys_[slot] == key){
+                storeTag(bucket, slot, EMPTY_TAG);
+                --size_;
+                unlockPair(stripe1, stripe2);
+                return;
+            }
+        }
+    }
+    unlockPair(stripe1, stripe2);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::clear(){
+    lockAll();
+    replaceTable(std::make_unique<Table>(initialBuckets_));
+    size_ = 0;
+    unlockAll();
+    reclaim();
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+bool ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::empty() const {
+    return size_.load() == 0;
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+size_t ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::size() const {
+    return size_.load();
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+double ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::loadFactor() const {
+    ReadGuard reading(*this);
+    return double(size_.load()) / ((table_.load()->mask_ + 1) * SlotsPerBucket);
+}
+
+// Bucket, Table and Stripe Functions
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::Bucket::Bucket():tags_{}{}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::Table::Table(size_t numBuckets):
+    mask_{numBuckets - 1}, buckets_{new Bucket[numBuckets]}{}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::Stripe::lock(){
+    while (true){
+        uint64_t version = version_.load(std::memory_order_relaxed);
+        if (!(version & 1) and version_.compare_exchange_weak(version, version + 1, std::memory_order_acquire)){
+            // Keeps the slot writes after this from becoming visible before the odd version
+            std::atomic_thread_fence(std::memory_order_release);
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+void ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::Stripe::unlock(){
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ReadGuard::ReadGuard(const ConcurrentCuckooHashMap &map):
+    map_{map}, count_{map.readers_[readerSlot()]}
+    {
+        count_.count_.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+template <typename key_t, typename value_t, size_t SlotsPerBucket, typename Hash>
+ConcurrentCuckooHashMap<key_t, value_t, SlotsPerBucket, Hash>::ReadGuard::~ReadGuard(){
+    count_.count_.fetch_sub(1, std::memory_order_release);
+    if (map_.numRetired_.load(std::memory_order_relaxed)){
+        map_.reclaim();
+    }
+}
@@ -0,0 +1,174 @@
+/**
+ * @file concurrent-cuckoo-hash.hpp
+ * @brief Concurrent bucketized Cuckoo Hash Map for read-mostly workloads, in
+ * the style of libcuckoo. Buckets are protected by striped locks that double
+ * as version counters, so readers of trivially copyable keys and values never
+ * take a lock.
+ * @note Keys and Values must be default constructible and movable
+ *
+ */
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <type_traits>
+#include <functional>
+#include <mutex>
+
+#include "cuckoo-hash-policy.hpp"
+
+#ifndef CONCURRENT_CUCKOO_HASH_HPP_INCLUDED
+#define CONCURRENT_CUCKOO_HASH_HPP_INCLUDED
+
+/**
+ * @brief Thread safe Cuckoo Hash Map. Any number of threads may call any
+ * member function at the same time.
+ *
+ * Uses partial-key cuckoo hashing: a key's second bucket is computed from its
+ * first bucket and its 8 bit tag, so an item can be moved without reading (or
+ * rehashing) its key. Inserts that find both buckets full search for the
+ * shortest eviction path breadth first, reading only tags, then move the items
+ * along the path one locked step at a time.
+ *
+ * Readers of trivially copyable keys and values are optimistic: they read the
+ * versions of the two lock stripes, probe, and retry if either version changed.
+ * Other types take the two stripe locks to read.
+ *
+ * Growing or clearing the table locks every stripe. The old table is freed
+ * once no thread that reads without locks can still be probing it.
+ *
+ * @tparam key_t Key type
+ * @tparam value_t Value type
+ * @tparam SlotsPerBucket Number of slots in a bucket. Between 1 and 8.
+ * @tparam Hash Hash policy, see cuckoo-hash-policy.hpp
+ */
+template <typename key_t, typename value_t, size_t SlotsPerBucket = 4, typename Hash = MixHashPolicy<key_t>>
+class ConcurrentCuckooHashMap
+{
+    static_assert(SlotsPerBucket > 0 and SlotsPerBucket <= 8, "A bucket has at most 8 slots");
+    static_assert(CuckooHashPolicy<Hash, key_t>, "Hash must provide hash1(key) and hash2(hash1)");
+
+  private:
+    struct alignas(64) Bucket {
+        uint8_t tags_[SlotsPerBucket]; // EMPTY_TAG if the slot is free
+        key_t keys_[SlotsPerBucket];
+        value_t values_[SlotsPerBucket];
+
+        Bucket();
+    };
+
+    struct Table {
+        size_t mask_; // Number of buckets - 1, the number of buckets is a power of 2
+        std::unique_ptr<Bucket[]> buckets_;
+
+        Table(size_t numBuckets);
+    };
+
+    // A spin lock whose value is also a version number. Odd while locked,
+    // every unlock moves it to a new even version.
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> version_{0};
+
+        void lock();
+        void unlock();
+    };
+
+    // Threads that probe a table without holding its stripes (optimistic
+    // readers and the eviction path search). Split over cache lines so readers
+    // on different threads rarely share a counter.
+    struct alignas(64) ReaderCount {
+        std::atomic<size_t> count_{0};
+    };
+
+    // Counts the calling thread as a reader for as long as it lives
+    class ReadGuard {
+        const ConcurrentCuckooHashMap &map_;
+        ReaderCount &count_;
+
+      public:
+        explicit ReadGuard(const ConcurrentCuckooHashMap &map);
+        ~ReadGuard();
+    };
+
+    // One step of an eviction path found by the breadth first search
+    struct PathNode {
+        size_t bucket_;
+        size_t parent_; // Index of the previous node, NO_PARENT for the key's own buckets
+        size_t slot_; // Slot of the parent bucket whose item moves into this bucket
+        size_t depth_;
+    };
+
+    static constexpr uint8_t EMPTY_TAG = 0;
+    static constexpr size_t NO_PARENT = size_t(-1);
+    static constexpr size_t MAX_STRIPES = 1 << 14;
+    static constexpr size_t READER_COUNTS = 64;
+    static constexpr bool OPTIMISTIC_READS = std::is_trivially_copyable_v<key_t> and std::is_trivially_copyable_v<value_t>;
+
+    // Data
+    std::atomic<Table*> table_;
+    std::unique_ptr<Table> current_; // Owns table_
+    mutable std::mutex retiredMutex_;
+    mutable std::vector<std::unique_ptr<Table>> retired_; // Replaced tables a reader may still be probing
+    mutable std::atomic<size_t> numRetired_;
+    std::unique_ptr<ReaderCount[]> readers_;
+    std::unique_ptr<Stripe[]> stripes_;
+    size_t numStripes_;
+    size_t initialBuckets_;
+    size_t maxPathDepth_;
+    std::atomic<size_t> size_;
+    Hash hash_;
+
+    // Helper Functions
+    size_t getHash1(const key_t& key) const;
+    uint8_t getTag(size_t hash1) const;
+    static size_t altBucket(size_t bucket, uint8_t tag);
+    static uint8_t loadTag(const Bucket &bucket, size_t slot);
+    static void storeTag(Bucket &bucket, size_t slot, uint8_t tag);
+    size_t stripe(size_t bucket) const;
+    void lockPair(size_t stripe1, size_t stripe2) const;
+    void unlockPair(size_t stripe1, size_t stripe2) const;
+    void lockAll() const;
+    void unlockAll() const;
+    static size_t readerSlot(); // Fixed for each thread
+    void replaceTable(std::unique_ptr<Table> table); // Every stripe must be locked
+    void reclaim() const; // Frees the retired tables if no thread is reading
+
+    bool findInTable(const Table &table, size_t hash1, uint8_t tag, const key_t &key, value_t *value) const;
+    bool search(const key_t &key, value_t *value) const;
+    bool cuckooPath(Table *table, size_t bucket1, size_t bucket2);
+    bool movePath(Table *table, const std::vector<PathNode> &nodes, size_t end);
+    void grow(Table *table);
+    static bool insertUnlocked(Table &table, size_t hash1, uint8_t tag, key_t &key, value_t &value, size_t maxLoop);
+
+  public:
+
+    // Type Names:
+    using value_type = std::pair<key_t, value_t>;
+    using key_type = key_t;
+    using mapped_type = value_t;
+
+    // Constructors
+    ConcurrentCuckooHashMap();
+    ConcurrentCuckooHashMap(size_t initialBuckets, size_t maxPathDepth);
+    ~ConcurrentCuckooHashMap() = default;
+    ConcurrentCuckooHashMap(const ConcurrentCuckooHashMap &other) = delete;
+    ConcurrentCuckooHashMap &operator=(const ConcurrentCuckooHashMap &other) = delete;
+
+    // Modification and Lookup
+    bool contains(const key_t &key) const;
+    bool find(const key_t &key, value_t &value) const; // Copies the value out if the key is present
+    value_t lookup(const key_t &key) const; // Throws std::out_of_range if the key is not present
+    void insert(const key_t &key, const value_t &value);
+    void erase(const key_t &key);
+    void clear();
+
+    // Data Lookup
+    bool empty() const;
+    size_t size() const;
+    double loadFactor() const;
+};
+
+#include "concurrent-cuckoo-hash-private.hpp"
+
+#endif // CONCURRENT_CUCKOO_HASH_HPP_INCLUDED
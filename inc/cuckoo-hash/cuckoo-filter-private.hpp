@@ -0,0 +1,302 @@
+#include "cuckoo-filter.hpp"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <bit>
+#include <cmath>
+
+/*****************
+ * Cuckoo Filter *
+ *****************/
+
+template <typename T, typename Hash>
+CuckooFilter<T, Hash>::CuckooFilter():
+    CuckooFilter(1024, 0.01)
+    {
+        // Nothing here
+    }
+
+template <typename T, typename Hash>
+CuckooFilter<T, Hash>::CuckooFilter(size_t capacity, double falsePositiveRate)
+    {
+        allocate(capacity, fingerprintBitsFor(falsePositiveRate));
+    }
+
+template <typename T, typename Hash>
+CuckooFilter<T, Hash> CuckooFilter<T, Hash>::withFingerprintBits(size_t capacity, size_t fingerprintBits){
+    if (fingerprintBits < 1 or fingerprintBits > 32){
+        throw std::invalid_argument("Fingerprints must have 1 to 32 bits");
+    }
+    return CuckooFilter(ExactBits{}, capacity, fingerprintBits);
+}
+
+template <typename T, typename Hash>
+CuckooFilter<T, Hash>::CuckooFilter(ExactBits, size_t capacity, size_t fingerprintBits)
+    {
+        allocate(capacity, fingerprintBits);
+    }
+
+template <typename T, typename Hash>
+size_t CuckooFilter<T, Hash>::fingerprintBitsFor(double falsePositiveRate){
+    if (falsePositiveRate <= 0 or falsePositiveRate >= 1){
+        throw std::invalid_argument("False positive rate must be in range (0, 1)");
+    }
+    // A lookup compares against at most 2 * SLOTS_PER_BUCKET fingerprints
+    size_t bits = 1;
+    while (bits < 32 and 2.0 * SLOTS_PER_BUCKET / std::ldexp(1.0, int(bits)) > falsePositiveRate){
+        ++bits;
+    }
+    return bits;
+}
+
+template <typename T, typename Hash>
+void CuckooFilter<T, Hash>::allocate(size_t capacity, size_t fingerprintBits){
+    numBuckets_ = size_t(std::ceil(double(std::max<size_t>(capacity, 1)) / (SLOTS_PER_BUCKET * MAX_LOAD)));
+    bits_ = fingerprintBits;
+    // One extra word so a fingerprint that crosses a word boundary never reads past the end
+    slots_.assign(numBuckets_ * SLOTS_PER_BUCKET * bits_ / 64 + 2, 0);
+    size_ = 0;
+    victim_ = EMPTY;
+    victimBucket_ = 0;
+}
+
+template <typename T, typename Hash>
+typename CuckooFilter<T, Hash>::Probe CuckooFilter<T, Hash>::probe(const T& key) const {
+    // The bucket comes from the low bits of the mixed hash and the fingerprint from the high bits
+    uint64_t hash = hash_.hash2(hash_.hash1(key));
+    uint32_t fingerprint = uint32_t(hash >> (64 - bits_));
+    if (fingerprint == EMPTY){
+        fingerprint = 1;
+    }
+    size_t bucket1 = (hash & ((uint64_t(1) << (64 - bits_)) - 1)) % numBuckets_;
+    return Probe{fingerprint, bucket1, altBucket(bucket1, fingerprint)};
+}
+
+template <typename T, typename Hash>
+size_t CuckooFilter<T, Hash>::altBucket(size_t bucket, uint32_t fingerprint) const {
+    // Reflects bucket around a point picked by the fingerprint, so altBucket(altBucket(b, f), f) == b.
+    // Unlike XOR this works for any number of buckets, the table does not round up to a power of 2.
+    size_t pivot = (uint64_t(fingerprint) * 0x5BD1E995) % numBuckets_;
+    return pivot >= bucket ? pivot - bucket : pivot + numBuckets_ - bucket;
+}
+
+template <typename T, typename Hash>
+uint32_t CuckooFilter<T, Hash>::get(size_t bucket, size_t slot) const {
+    size_t bit = (bucket * SLOTS_PER_BUCKET + slot) * bits_;
+    size_t word = bit / 64;
+    size_t offset = bit % 64;
+    uint64_t value = slots_[word] >> offset;
+    if (offset + bits_ > 64){
+        value |= slots_[word + 1] << (64 - offset);
+    }
+    return uint32_t(value & ((uint64_t(1) << bits_) - 1));
+}
+
+template <typename T, typename Hash>
+void CuckooFilter<T, Hash>::set(size_t bucket, size_t slot, uint32_t fingerprint) {
+    size_t bit = (bucket * SLOTS_PER_BUCKET + slot) * bits_;
+    size_t word = bit / 64;
+    size_t offset = bit % 64;
+    uint64_t mask = (uint64_t(1) << bits_) - 1;
+    slots_[word] = (slots_[word] & ~(mask << offset)) | (uint64_t(fingerprint) << offset);
+    if (offset + bits_ > 64){
+        size_t low = 64 - offset; // Bits already written to the first word
+        slots_[word + 1] = (slots_[word + 1] & ~(mask >> low)) | (uint64_t(fingerprint) >> low);
+    }
+}
+
+template <typename T, typename Hash>
+bool CuckooFilter<T, Hash>::findIn(size_t bucket, uint32_t fingerprint) const {
+    for (size_t slot = 0; slot < SLOTS_PER_BUCKET; ++slot){
+        if (get(bucket, slot) == fingerprint){
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T, typename Hash>
+bool CuckooFilter<T, Hash>::addTo(size_t bucket, uint32_t fingerprint) {
+    for (size_t slot = 0; slot < SLOTS_PER_BUCKET; ++slot){
+        if (get(bucket, slot) == EMPTY){
+            set(bucket, slot, fingerprint);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T, typename Hash>
+bool CuckooFilter<T, Hash>::removeFrom(size_t bucket, uint32_t fingerprint) {
+    for (size_t slot = 0; slot < SLOTS_PER_BUCKET; ++slot){
+        if (get(bucket, slot) == fingerprint){
+            set(bucket, slot, EMPTY);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T, typename Hash>
+bool CuckooFilter<T, Hash>::insert(const Probe& probe) {
+    if (victim_ != EMPTY){
+        // The last insert could not place everything, the filter is full
+        return false;
+    }
+    if (addTo(probe.bucket1_, probe.fingerprint_) or addTo(probe.bucket2_, probe.fingerprint_)){
+        ++size_;
+        return true;
+    }
+    // Random walk: evict a fingerprint and move it to its other bucket
+    uint32_t fingerprint = probe.fingerprint_;
+    size_t bucket = (rng_() & 1) ? probe.bucket1_ : probe.bucket2_;
+    for (size_t kick = 0; kick < MAX_KICKS; ++kick){
+        size_t slot = rng_() % SLOTS_PER_BUCKET;
+        uint32_t evicted = get(bucket, slot);
+        set(bucket, slot, fingerprint);
+        fingerprint = evicted;
+        bucket = altBucket(bucket, fingerprint);
+        if (addTo(bucket, fingerprint)){
+            ++size_;
+            return true;
+        }
+    }
+    // The new key is in the table, but some other fingerprint has no slot.
+    // Keep it aside so it is still found, and refuse further inserts.
+    victim_ = fingerprint;
+    victimBucket_ = bucket;
+    ++size_;
+    return true;
+}
+
+template <typename T, typename Hash>
+bool CuckooFilter<T, Hash>::contains(const T& key) const {
+    Probe p = probe(key);
+    if (findIn(p.bucket1_, p.fingerprint_) or findIn(p.bucket2_, p.fingerprint_)){
+        return true;
+    }
+    return victim_ == p.fingerprint_ and (victimBucket_ == p.bucket1_ or victimBucket_ == p.bucket2_);
+}
+
+template <typename T, typename Hash>
+bool CuckooFilter<T, Hash>::insert(const T& key) {
+    return insert(probe(key));
+}
+
+template <typename T, typename Hash>
+bool CuckooFilter<T, Hash>::erase(const T& key) {
+    Probe p = probe(key);
+    if (victim_ == p.fingerprint_ and (victimBucket_ == p.bucket1_ or victimBucket_ == p.bucket2_)){
+        victim_ = EMPTY;
+        --size_;
+        return true;
+    }
+    if (!removeFrom(p.bucket1_, p.fingerprint_) and !removeFrom(p.bucket2_, p.fingerprint_)){
+        return false;
+    }
+    --size_;
+    if (victim_ != EMPTY){
+        // A slot is free again, try to place the set aside fingerprint
+        uint32_t victim = victim_;
+        victim_ = EMPTY;
+        --size_;
+        insert(Probe{victim, victimBucket_, altBucket(victimBucket_, victim)});
+    }
+    return true;
+}
+
+template <typename T, typename Hash>
+void CuckooFilter<T, Hash>::clear() {
+    std::fill(slots_.begin(), slots_.end(), 0);
+    size_ = 0;
+    victim_ = EMPTY;
+}
+
+template <typename T, typename Hash>
+size_t CuckooFilter<T, Hash>::insertBatch(std::span<const T> keys) {
+    Probe probes[BATCH_SIZE];
+    for (size_t start = 0; start < keys.size(); start += BATCH_SIZE){
+        size_t count = std::min(BATCH_SIZE, keys.size() - start);
+        // Hash every key first so the loads of all candidate buckets are in flight together
+        for (size_t i = 0; i < count; ++i){
+            probes[i] = probe(keys[start + i]);
+            __builtin_prefetch(slots_.data() + probes[i].bucket1_ * SLOTS_PER_BUCKET * bits_ / 64, 1);
+            __builtin_prefetch(slots_.data() + probes[i].bucket2_ * SLOTS_PER_BUCKET * bits_ / 64, 1);
+        }
+        for (size_t i = 0; i < count; ++i){
+            if (!insert(probes[i])){
+                return start + i;
+            }
+        }
+    }
+    return keys.size();
+}
+
+template <typename T, typename Hash>
+bool CuckooFilter<T, Hash>::empty() const {
+    return size_ == 0;
+}
+
+template <typename T, typename Hash>
+size_t CuckooFilter<T, Hash>::size() const {
+    return size_;
+}
+
+template <typename T, typename Hash>
+size_t CuckooFilter<T, Hash>::slots() const {
+    return numBuckets_ * SLOTS_PER_BUCKET;
+}
+
+template <typename T, typename Hash>
+double CuckooFilter<T, Hash>::loadFactor() const {
+    return double(size_) / slots();
+}
+
+template <typename T, typename Hash>
+size_t CuckooFilter<T, Hash>::fingerprintBits() const {
+    return bits_;
+}
+
+template <typename T, typename Hash>
+size_t CuckooFilter<T, Hash>::memoryUsage() const {
+    return slots_.size() * sizeof(uint64_t);
+}
+
+template <typename T, typename Hash>
+double CuckooFilter<T, Hash>::falsePositiveRate() const {
+    // Each of the 2 * SLOTS_PER_BUCKET slots checked holds a fingerprint with probability loadFactor()
+    return 1.0 - std::pow(1.0 - std::ldexp(1.0, -int(bits_)), 2.0 * SLOTS_PER_BUCKET * loadFactor());
+}
+
+template <typename T, typename Hash>
+void CuckooFilter<T, Hash>::printToStream(std::ostream& out) const {
+    out << "[ ";
+    for (size_t bucket = 0; bucket < numBuckets_; ++bucket){
+        out << "(";
+        for (size_t slot = 0; slot < SLOTS_PER_BUCKET; ++slot){
+            uint32_t fingerprint = get(bucket, slot);
+            out << (slot ? " " : "");
+            if (fingerprint == EMPTY){
+                out << "-";
+            } else {
+                out << fingerprint;
+            }
+        }
+        out << ") ";
+    }
+    out << "]\n Fingerprint Bits: " << bits_ << " Num Buckets: " << numBuckets_ << " Size: " << size_;
+}
+
+template <typename T, typename Hash>
+std::string CuckooFilter<T, Hash>::to_string() const {
+    std::stringstream ss;
+    printToStream(ss);
+    return ss.str();
+}
+
+template <typename T, typename Hash>
+std::ostream& operator<<(std::ostream& os, const CuckooFilter<T, Hash>& cf){
+    os << cf.to_string();
+    return os;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file cuckoo-filter.hpp
+ * @brief Cuckoo Filter: approximate set membership with deletes. Stores a few
+ * bits of each key's hash instead of the key, in buckets of 4 slots.
+ * @note contains() can return true for a key that was never inserted, never
+ * false for one that was
+ *
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+#include <span>
+
+#include "cuckoo-hash-policy.hpp"
+
+#ifndef CUCKOO_FILTER_HPP_INCLUDED
+#define CUCKOO_FILTER_HPP_INCLUDED
+
+/**
+ * @brief Cuckoo Filter (Fan et al. 2014) with partial-key cuckoo hashing: a
+ * key's second bucket is computed from its first bucket and its fingerprint, so
+ * a fingerprint can be moved to its other bucket without knowing its key.
+ *
+ * Fingerprints are packed at fingerprintBits() bits each. The false positive
+ * rate is at most 8 / 2^fingerprintBits() when the filter is full and shrinks
+ * with the load factor.
+ *
+ * The filter cannot grow because the keys are not stored, insert() returns
+ * false once it is full. Inserting a key twice stores it twice, erase a key
+ * only as many times as it was inserted.
+ *
+ * @tparam T Key type
+ * @tparam Hash Hash policy, see cuckoo-hash-policy.hpp
+ */
+template <typename T, typename Hash = MixHashPolicy<T>>
+class CuckooFilter
+{
+    static_assert(CuckooHashPolicy<Hash, T>, "Hash must provide hash1(key) and hash2(hash1)");
+
+  private:
+    static constexpr size_t SLOTS_PER_BUCKET = 4;
+    static constexpr uint32_t EMPTY = 0; // Fingerprint of a free slot, real fingerprints are never 0
+    static constexpr size_t MAX_KICKS = 500; // Evictions before an insert gives up
+    static constexpr double MAX_LOAD = 0.9; // Buckets are sized so capacity keys fill at most this much of slots(). Inserts start failing near 95%
+
+    // Fingerprint and buckets of a key
+    struct Probe {
+        uint32_t fingerprint_;
+        size_t bucket1_;
+        size_t bucket2_;
+    };
+
+    // Data
+    std::vector<uint64_t> slots_; // numBuckets_ * SLOTS_PER_BUCKET fingerprints packed at bits_ each
+    size_t numBuckets_;
+    size_t bits_;
+    size_t size_;
+    uint32_t victim_; // Fingerprint evicted by the last failed insert, EMPTY if none
+    size_t victimBucket_;
+    Hash hash_;
+    std::minstd_rand rng_; // Chooses which slot of a full bucket is evicted
+
+    // Helper Functions
+    Probe probe(const T &key) const;
+    size_t altBucket(size_t bucket, uint32_t fingerprint) const;
+    uint32_t get(size_t bucket, size_t slot) const;
+    void set(size_t bucket, size_t slot, uint32_t fingerprint);
+    bool findIn(size_t bucket, uint32_t fingerprint) const;
+    bool addTo(size_t bucket, uint32_t fingerprint);
+    bool removeFrom(size_t bucket, uint32_t fingerprint);
+    bool insert(const Probe &probe);
+    void allocate(size_t capacity, size_t fingerprintBits);
+    void printToStream(std::ostream &os) const;
+
+    struct ExactBits {}; // Tag for the constructor behind withFingerprintBits
+    CuckooFilter(ExactBits, size_t capacity, size_t fingerprintBits);
+
+    // Number of keys hashed and prefetched before any of them are inserted
+    static constexpr size_t BATCH_SIZE = 16;
+
+  public:
+
+    // Type Names:
+    using value_type = T;
+    using key_type = T;
+
+    // Constructors
+    CuckooFilter(); // 1024 keys with a 1% false positive rate
+    CuckooFilter(size_t capacity, double falsePositiveRate); // Picks the fingerprint size for the rate
+    static CuckooFilter withFingerprintBits(size_t capacity, size_t fingerprintBits); // 1 to 32 bits
+
+    // Smallest fingerprint whose false positive rate is at most falsePositiveRate
+    static size_t fingerprintBitsFor(double falsePositiveRate);
+
+    // Modification and Lookup
+    bool contains(const T &key) const; // Always true for inserted keys, sometimes for others
+    bool insert(const T &key); // false if the filter is full, the key was not added
+    bool erase(const T &key); // Only erase keys that were inserted. false if no fingerprint matched
+    void clear();
+
+    // Bulk insert. Prefetches the buckets of many keys at once, returns the number inserted.
+    // Stops at the first key that does not fit.
+    size_t insertBatch(std::span<const T> keys);
+
+    // Data Lookup
+    bool empty() const;
+    size_t size() const;
+    size_t slots() const; // Number of fingerprint slots, about 1.11x the capacity it was built for
+    double loadFactor() const;
+    size_t fingerprintBits() const;
+    size_t memoryUsage() const; // Bytes of fingerprints
+    double falsePositiveRate() const; // Upper bound at the current load
+    std::string to_string() const;
+};
+
+template<typename T, typename Hash>
+std::ostream &operator<<(std::ostream& os, const CuckooFilter<T, Hash> &cf);
+
+#include "cuckoo-filter-private.hpp"
+
+#endif // CUCKOO_FILTER_HPP_INCLUDED
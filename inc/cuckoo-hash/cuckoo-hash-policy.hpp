@@ -0,0 +1,118 @@
+/**
+ * @file cuckoo-hash-policy.hpp
+ * @brief Hash policies for the cuckoo hash tables. A policy hashes a key once
+ * and derives the second table's hash from the first hash, so a key is only
+ * ever hashed by the (possibly expensive) key hash function once.
+ *
+ */
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <concepts>
+#include <functional>
+
+#ifndef CUCKOO_HASH_POLICY_HPP_INCLUDED
+#define CUCKOO_HASH_POLICY_HPP_INCLUDED
+
+// A hash policy hashes a key and derives a second, independent hash from it
+template <typename Policy, typename key_t>
+concept CuckooHashPolicy = requires(const Policy &policy, const key_t &key, size_t hash1) {
+    { policy.hash1(key) } -> std::convertible_to<size_t>;
+    { policy.hash2(hash1) } -> std::convertible_to<size_t>;
+};
+
+// A transparent policy also hashes other types that compare equal to keys,
+// like std::string_view for std::string keys, without building a key first.
+template <typename Policy, typename key_t, typename K>
+concept TransparentHashPolicy = requires(const Policy &policy, const K &other, const key_t &key) {
+    { policy.template hash1<K>(other) } -> std::convertible_to<size_t>;
+    { key == other } -> std::convertible_to<bool>;
+};
+
+/**
+ * @brief Hashes std::string, std::string_view and string literals to the same
+ * value as std::hash<std::string>.
+ */
+struct StringViewHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+};
+
+// Key hash used by the policies unless one is given. Transparent for strings.
+template <typename key_t>
+struct DefaultKeyHash { using type = std::hash<key_t>; };
+
+template <>
+struct DefaultKeyHash<std::string> { using type = StringViewHash; };
+
+/**
+ * @brief Default policy. The second hash is the splitmix64 finalizer of the
+ * first hash: a few shifts and multiplies, no allocation.
+ */
+template <typename key_t, typename Hash = typename DefaultKeyHash<key_t>::type>
+struct MixHashPolicy {
+    Hash hash_;
+    uint64_t seed_ = 0;
+
+    size_t hash1(const key_t &key) const { return hash_(key); }
+
+    template <typename K> requires requires { typename Hash::is_transparent; }
+    size_t hash1(const K &key) const { return hash_(key); }
+
+    size_t hash2(size_t hash1) const {
+        uint64_t x = uint64_t(hash1) ^ seed_;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return size_t(x ^ (x >> 31));
+    }
+};
+
+/**
+ * @brief wyhash style policy. The second hash folds the 128 bit product of the
+ * first hash and a constant, one multiply instead of two.
+ */
+template <typename key_t, typename Hash = typename DefaultKeyHash<key_t>::type>
+struct WyHashPolicy {
+    Hash hash_;
+    uint64_t seed_ = 0;
+
+    size_t hash1(const key_t &key) const { return hash_(key); }
+
+    template <typename K> requires requires { typename Hash::is_transparent; }
+    size_t hash1(const K &key) const { return hash_(key); }
+
+    size_t hash2(size_t hash1) const {
+        __uint128_t r = __uint128_t(uint64_t(hash1) ^ seed_ ^ 0xA0761D6478BD642Full) * 0xE7037ED1A0B428DBull;
+        return size_t(uint64_t(r) ^ uint64_t(r >> 64));
+    }
+};
+
+/**
+ * @brief Original policy. Hashes the 8 bytes of the first hash as a string.
+ * Allocates on every call, kept for benchmarking against the other policies.
+ */
+template <typename key_t, typename Hash = typename DefaultKeyHash<key_t>::type>
+struct StringHashPolicy {
+    Hash hash_;
+    std::hash<std::string> stringHash_;
+
+    size_t hash1(const key_t &key) const { return hash_(key); }
+
+    template <typename K> requires requires { typename Hash::is_transparent; }
+    size_t hash1(const K &key) const { return hash_(key); }
+
+    size_t hash2(size_t hash1) const {
+        std::string key_str;
+        for (size_t byte = 0; byte < 8; ++byte)
+        {
+            unsigned char c = hash1 & 255;
+            key_str += c;
+            hash1 >>= 8;
+        }
+        return stringHash_(key_str);
+    }
+};
+
+#endif // CUCKOO_HASH_POLICY_HPP_INCLUDED
@@ -1,6 +1,16 @@
 #include "cuckoo-hash.hpp"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <bit>
+#include <chrono>
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 using namespace std;
 
@@ -8,98 +18,330 @@ using namespace std;
  * Cuckoo Hash Map *
  *******************/
 
-template <typename key_t, typename value_t>
-CuckooHashMap<key_t, value_t>::CuckooHashMap():
+template <typename key_t, typename value_t, typename Hash>
+CuckooHashMap<key_t, value_t, Hash>::CuckooHashMap():
     table1_{new Item[2]}, 
     table2_{new Item[2]}, 
+    stash_{new Item[STASH_SIZE]},
+    stashSize_{0},
+    oldTable1_{nullptr},
+    oldTable2_{nullptr},
+    oldNumBuckets_{0},
+    migrated_{0},
+    rehashStep_{0},
     epsilon_{0.4}, // ??
     size_{0},
     maxLoop_{1}, // ??
+    maxPathDepth_{0},
     numBuckets_{2},
-    downsizeThresh_{0.2}
+    downsizeThresh_{0.2},
+    mapping_{nullptr},
+    mappingSize_{0}
     {
         // Nothing here
     }
 
-template<typename key_t, typename value_t>
-CuckooHashMap<key_t, value_t>::CuckooHashMap(double epsilon, float downsizeThresh):
+template <typename key_t, typename value_t, typename Hash>
+CuckooHashMap<key_t, value_t, Hash>::CuckooHashMap(double epsilon, float downsizeThresh):
+    CuckooHashMap(epsilon, downsizeThresh, 0)
+    {
+        // Nothing here
+    }
+
+template <typename key_t, typename value_t, typename Hash>
+CuckooHashMap<key_t, value_t, Hash>::CuckooHashMap(double epsilon, float downsizeThresh, size_t maxPathDepth):
+    CuckooHashMap(epsilon, downsizeThresh, maxPathDepth, 0)
+    {
+        // Nothing here
+    }
+
+template <typename key_t, typename value_t, typename Hash>
+CuckooHashMap<key_t, value_t, Hash>::CuckooHashMap(double epsilon, float downsizeThresh, size_t maxPathDepth, size_t rehashStep):
     table1_{new Item[2]}, 
     table2_{new Item[2]}, 
+    stash_{new Item[STASH_SIZE]},
+    stashSize_{0},
+    oldTable1_{nullptr},
+    oldTable2_{nullptr},
+    oldNumBuckets_{0},
+    migrated_{0},
+    rehashStep_{rehashStep},
     epsilon_{epsilon}, // ??
     size_{0},
     maxLoop_{2}, // ??
+    maxPathDepth_{maxPathDepth},
     numBuckets_{2},
-    downsizeThresh_{downsizeThresh}
+    downsizeThresh_{downsizeThresh},
+    mapping_{nullptr},
+    mappingSize_{0}
     {
         // Nothing here
     }
 
-template<typename key_t, typename value_t>
-CuckooHashMap<key_t, value_t>::~CuckooHashMap(){
-    delete[] table1_;
-    delete[] table2_;
+template <typename key_t, typename value_t, typename Hash>
+CuckooHashMap<key_t, value_t, Hash>::~CuckooHashMap(){
+    freeTable(table1_);
+    freeTable(table2_);
+    freeTable(oldTable1_);
+    freeTable(oldTable2_);
+    delete[] stash_;
 }
 
-template<typename key_t, typename value_t>
-size_t CuckooHashMap<key_t, value_t>::getHash1(const key_t& key) const {
-    return hash1_(key);
-}
+template <typename key_t, typename value_t, typename Hash>
+CuckooHashMap<key_t, value_t, Hash>::CuckooHashMap(const CuckooHashMap &other):
+    table1_{new Item[other.numBuckets_]},
+    table2_{new Item[other.numBuckets_]},
+    stash_{new Item[STASH_SIZE]},
+    stashSize_{other.stashSize_},
+    oldTable1_{other.oldTable1_ ? new Item[other.oldNumBuckets_] : nullptr},
+    oldTable2_{other.oldTable2_ ? new Item[other.oldNumBuckets_] : nullptr},
+    oldNumBuckets_{other.oldNumBuckets_},
+    migrated_{other.migrated_},
+    rehashStep_{other.rehashStep_},
+    epsilon_{other.epsilon_},
+    size_{other.size_},
+    maxLoop_{other.maxLoop_},
+    maxPathDepth_{other.maxPathDepth_},
+    numBuckets_{other.numBuckets_},
+    hash_{other.hash_},
+    downsizeThresh_{other.downsizeThresh_},
+    mapping_{nullptr}, // Tables read from a snapshot are copied onto the heap
+    mappingSize_{0}
+#ifdef CUCKOO_HASH_STATISTICS
+    , stats_{other.stats_}
+#endif
+    {
+        std::copy(other.table1_, other.table1_ + numBuckets_, table1_);
+        std::copy(other.table2_, other.table2_ + numBuckets_, table2_);
+        std::copy(other.stash_, other.stash_ + STASH_SIZE, stash_);
+        if (oldTable1_){
+            std::copy(other.oldTable1_, other.oldTable1_ + oldNumBuckets_, oldTable1_);
+            std::copy(other.oldTable2_, other.oldTable2_ + oldNumBuckets_, oldTable2_);
+        }
+    }
 
-template<typename key_t, typename value_t>
-size_t CuckooHashMap<key_t, value_t>::getHash2(size_t hash1) const {
-    string key_str;
-    for (size_t byte = 0; byte < 8; ++byte)
+template <typename key_t, typename value_t, typename Hash>
+CuckooHashMap<key_t, value_t, Hash>::CuckooHashMap(void *mapping, size_t mappingSize):
+    stash_{new Item[STASH_SIZE]},
+    mapping_{mapping},
+    mappingSize_{mappingSize}
     {
-        unsigned char c = hash1 & 255;
-        key_str += c;
-        hash1 >>= 8;
+        const SnapshotHeader &header = *static_cast<const SnapshotHeader*>(mapping);
+        Item *items = reinterpret_cast<Item*>(static_cast<char*>(mapping) + sizeof(SnapshotHeader));
+        numBuckets_ = header.numBuckets_;
+        oldNumBuckets_ = header.oldNumBuckets_;
+        table1_ = items;
+        table2_ = items + numBuckets_;
+        std::copy(items + 2 * numBuckets_, items + 2 * numBuckets_ + STASH_SIZE, stash_);
+        oldTable1_ = oldNumBuckets_ ? items + 2 * numBuckets_ + STASH_SIZE : nullptr;
+        oldTable2_ = oldNumBuckets_ ? oldTable1_ + oldNumBuckets_ : nullptr;
+        stashSize_ = header.stashSize_;
+        migrated_ = header.migrated_;
+        rehashStep_ = header.rehashStep_;
+        epsilon_ = header.epsilon_;
+        size_ = header.size_;
+        maxLoop_ = header.maxLoop_;
+        maxPathDepth_ = header.maxPathDepth_;
+        downsizeThresh_ = header.downsizeThresh_;
+    }
+
+template <typename key_t, typename value_t, typename Hash>
+bool CuckooHashMap<key_t, value_t, Hash>::isMapped(const Item *table) const {
+    uintptr_t address = reinterpret_cast<uintptr_t>(table);
+    uintptr_t start = reinterpret_cast<uintptr_t>(mapping_);
+    return mapping_ and address >= start and address < start + mappingSize_;
+}
+
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::freeTable(Item *&table){
+    if (!isMapped(table)){
+        delete[] table;
+    }
+    table = nullptr;
+    if (mapping_ and !isMapped(table1_) and !isMapped(table2_) and !isMapped(oldTable1_) and !isMapped(oldTable2_)){
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+    }
+}
+
+template <typename key_t, typename value_t, typename Hash>
+template <typename K>
+size_t CuckooHashMap<key_t, value_t, Hash>::getHash1(const K& key) const {
+    return hash_.hash1(key);
+}
+
+template <typename key_t, typename value_t, typename Hash>
+size_t CuckooHashMap<key_t, value_t, Hash>::getHash2(size_t hash1) const {
+    return hash_.hash2(hash1);
+}
+
+template <typename key_t, typename value_t, typename Hash>
+typename CuckooHashMap<key_t, value_t, Hash>::Item& CuckooHashMap<key_t, value_t, Hash>::slot(const PathNode& node) const {
+    return node.table2_ ? table2_[node.index_] : table1_[node.index_];
+}
+
+template <typename key_t, typename value_t, typename Hash>
+template <typename K>
+typename CuckooHashMap<key_t, value_t, Hash>::Item* CuckooHashMap<key_t, value_t, Hash>::findItem(const K& key) const {
+    size_t hash1 = getHash1(key);
+    Item &item1 = table1_[hash1 % numBuckets_];
+    if (item1.valid_ and item1.key_ == key){
+        countProbes(1, 1);
+        return &item1;
+    }
+    // Only compute hash2 if not found in hash1. Hashing is expensive
+    Item &item2 = table2_[getHash2(hash1) % numBuckets_];
+    countProbes(1, 2);
+    if (item2.valid_ and item2.key_ == key){
+        return &item2;
+    }
+    return findOverflow(key, hash1);
+}
+
+template <typename key_t, typename value_t, typename Hash>
+template <typename K>
+typename CuckooHashMap<key_t, value_t, Hash>::Item* CuckooHashMap<key_t, value_t, Hash>::findOverflow(const K& key, size_t hash1) const {
+    if (oldTable1_){
+        countProbes(0, 2);
+        Item &old1 = oldTable1_[hash1 % oldNumBuckets_];
+        if (old1.valid_ and old1.key_ == key){
+            return &old1;
+        }
+        Item &old2 = oldTable2_[getHash2(hash1) % oldNumBuckets_];
+        if (old2.valid_ and old2.key_ == key){
+            return &old2;
+        }
+    }
+    return stashSize_ > 0 ? findInStash(key) : nullptr;
+}
+
+template <typename key_t, typename value_t, typename Hash>
+typename CuckooHashMap<key_t, value_t, Hash>::Item* CuckooHashMap<key_t, value_t, Hash>::itemAt(size_t idx) const {
+    if (idx < numBuckets_){
+        return table1_ + idx;
+    }
+    idx -= numBuckets_;
+    if (idx < numBuckets_){
+        return table2_ + idx;
+    }
+    idx -= numBuckets_;
+    if (idx < stashSize_){
+        return stash_ + idx;
     }
-    return  hash2_(key_str);
+    idx -= stashSize_;
+    if (idx < oldNumBuckets_){
+        return oldTable1_ + idx;
+    }
+    return oldTable2_ + idx - oldNumBuckets_;
+}
+
+template <typename key_t, typename value_t, typename Hash>
+size_t CuckooHashMap<key_t, value_t, Hash>::numSlots() const {
+    return 2 * numBuckets_ + stashSize_ + 2 * oldNumBuckets_;
+}
+
+template <typename key_t, typename value_t, typename Hash>
+template <typename K>
+typename CuckooHashMap<key_t, value_t, Hash>::Item* CuckooHashMap<key_t, value_t, Hash>::findInStash(const K& key) const {
+    for (Item *item = stash_; item < stash_ + stashSize_; ++item){
+        if (item->key_ == key){
+            countProbes(0, item - stash_ + 1);
+            return item;
+        }
+    }
+    countProbes(0, stashSize_);
+    return nullptr;
 }
 
-template<typename key_t, typename value_t>
-double CuckooHashMap<key_t, value_t>::loadFactor() const{
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::countProbes([[maybe_unused]] size_t lookups, [[maybe_unused]] size_t probes) const {
+#ifdef CUCKOO_HASH_STATISTICS
+    stats_.lookups_ += lookups;
+    stats_.probes_ += probes;
+#endif
+}
+
+template <typename key_t, typename value_t, typename Hash>
+double CuckooHashMap<key_t, value_t, Hash>::loadFactor() const{
     return double(size_) / (2 * numBuckets_);
 }
 
-template<typename key_t, typename value_t>
-bool CuckooHashMap<key_t, value_t>::empty() const{
+#ifdef CUCKOO_HASH_STATISTICS
+template <typename key_t, typename value_t, typename Hash>
+CuckooHashStats CuckooHashMap<key_t, value_t, Hash>::stats() const {
+    CuckooHashStats stats = stats_;
+    auto count = [](const Item *table, size_t size){
+        return size_t(std::count_if(table, table + size, [](const Item &item){ return item.valid_; }));
+    };
+    stats.numBuckets_ = numBuckets_;
+    stats.table1Items_ = count(table1_, numBuckets_);
+    stats.table2Items_ = count(table2_, numBuckets_);
+    stats.stashItems_ = stashSize_;
+    stats.oldTableItems_ = oldTable1_ ? count(oldTable1_, oldNumBuckets_) + count(oldTable2_, oldNumBuckets_) : 0;
+    return stats;
+}
+
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::resetStats(){
+    stats_ = CuckooHashStats();
+}
+#endif
+
+template <typename key_t, typename value_t, typename Hash>
+bool CuckooHashMap<key_t, value_t, Hash>::empty() const{
     return size_ == 0;
 }
 
-template<typename key_t, typename value_t>
-size_t CuckooHashMap<key_t, value_t>::size() const{
+template <typename key_t, typename value_t, typename Hash>
+size_t CuckooHashMap<key_t, value_t, Hash>::size() const{
     return size_;
 }
 
-template <typename key_t, typename value_t>
-void CuckooHashMap<key_t, value_t>::clear(){
-    delete[] table1_;
-    delete[] table2_;
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::clear(){
+    freeTable(table1_);
+    freeTable(table2_);
+    freeTable(oldTable1_);
+    freeTable(oldTable2_);
+    delete[] stash_;
     table1_ = new Item[2];
     table2_ = new Item[2];
+    stash_ = new Item[STASH_SIZE];
+    stashSize_ = 0;
+    oldTable1_ = nullptr;
+    oldTable2_ = nullptr;
+    oldNumBuckets_ = 0;
+    migrated_ = 0;
     numBuckets_ = 2;
     maxLoop_ = 1;
     size_ = 0;
 }
 
-template <typename key_t, typename value_t>
-void CuckooHashMap<key_t, value_t>::rehash(size_t numBuckets){
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::rehash(size_t numBuckets){
+#ifdef CUCKOO_HASH_STATISTICS
+    auto start = std::chrono::steady_clock::now();
+#endif
+    // Also collects the old tables if an incremental rehash is in progress
     vector<Item> allItems;
-    for (Item *item = table1_; item < table1_ + numBuckets_; ++item)
+    for (size_t idx = 0; idx < numSlots(); ++idx)
     {
+        Item *item = itemAt(idx);
         if (item->valid_){
-            // May be able to avoid copy constructor by using std::move
-            allItems.push_back(*item);
+            allItems.push_back(std::move(*item));
         }
     }
-    for (Item *item = table2_; item < table2_ + numBuckets_; ++item){
-        if(item->valid_){
-            allItems.push_back(*item);
-        }
+    for (Item *item = stash_; item < stash_ + stashSize_; ++item){
+        item->valid_ = false;
     }
-    delete[] table1_;
-    delete[] table2_;
+    stashSize_ = 0;
+    freeTable(table1_);
+    freeTable(table2_);
+    freeTable(oldTable1_);
+    freeTable(oldTable2_);
+    oldNumBuckets_ = 0;
+    migrated_ = 0;
 
     // Rehash into new table;
     numBuckets_ = numBuckets;
@@ -107,124 +349,404 @@ void CuckooHashMap<key_t, value_t>::rehash(size_t numBuckets){
     table2_ = new Item[numBuckets_];
     for (Item &item : allItems)
     {
-        insert(item.key_, item.value_, false);
+        insertItem(item, false);
     }
+#ifdef CUCKOO_HASH_STATISTICS
+    // A rehash that overflows while reinserting is counted twice, with the inner time in both
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ++stats_.rehashes_;
+    stats_.rehashSeconds_ += seconds;
+    stats_.maxRehashSeconds_ = std::max(stats_.maxRehashSeconds_, seconds);
+#endif
     return;
 }
 
-template <typename key_t, typename value_t>
-bool CuckooHashMap<key_t, value_t>::contains(const key_t& key) const {
-    size_t hash1 = getHash1(key);
-    Item &item1 = table1_[hash1 % numBuckets_];
-    if (item1.valid_ and item1.key_ == key){
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::resize(size_t numBuckets){
+    if (rehashStep_ == 0 or oldTable1_){
+        // Stop the world. Also used if the new tables fill up before the last move finished.
+        rehash(numBuckets);
+        return;
+    }
+#ifdef CUCKOO_HASH_STATISTICS
+    ++stats_.incrementalResizes_;
+#endif
+    // Keep the current tables for lookups, inserts and erases move rehashStep_ of their slots at a time
+    oldTable1_ = table1_;
+    oldTable2_ = table2_;
+    oldNumBuckets_ = numBuckets_;
+    migrated_ = 0;
+    numBuckets_ = numBuckets;
+    table1_ = new Item[numBuckets_];
+    table2_ = new Item[numBuckets_];
+}
+
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::migrate(size_t numItems){
+    // Old tables being shrunk are mostly empty, so moving a fixed number of
+    // slots would fall behind. Empty slots are cheap, look at up to 8 per item.
+    size_t end = std::min(migrated_ + 8 * numItems, 2 * oldNumBuckets_);
+    for (size_t moved = 0; migrated_ < end and moved < numItems; ++migrated_){
+        Item &item = migrated_ < oldNumBuckets_ ? oldTable1_[migrated_] : oldTable2_[migrated_ - oldNumBuckets_];
+        if (!item.valid_){
+            continue;
+        }
+        if (!place(item)){
+            // The new tables are already full, finish in one rehash
+            rehash(numBuckets_ * 2);
+            return;
+        }
+        item.valid_ = false;
+        ++moved;
+    }
+    if (migrated_ == 2 * oldNumBuckets_){
+        freeTable(oldTable1_);
+        freeTable(oldTable2_);
+        oldNumBuckets_ = 0;
+        migrated_ = 0;
+    }
+}
+
+template <typename key_t, typename value_t, typename Hash>
+bool CuckooHashMap<key_t, value_t, Hash>::contains(const key_t& key) const {
+    return findItem(key) != nullptr;
+}
+
+template <typename key_t, typename value_t, typename Hash>
+bool CuckooHashMap<key_t, value_t, Hash>::cuckooPath(Item& newItem, size_t hash1){
+    // Breadth first search over the slots that would have to move, so the
+    // shortest path is found and nothing is moved until a free slot is known.
+    // Every occupied slot has one way out, the other slot of its item.
+    size_t maxDepth = maxPathDepth_ ? maxPathDepth_ : maxLoop_;
+    path_.clear();
+    path_.push_back(PathNode{false, hash1 % numBuckets_, NO_PARENT, 0});
+    path_.push_back(PathNode{true, getHash2(hash1) % numBuckets_, NO_PARENT, 0});
+    for (size_t i = 0; i < path_.size(); ++i){
+        PathNode node = path_[i];
+        Item &item = slot(node);
+        if (!item.valid_){
+            // Move each item on the path into the free slot after it
+            size_t child = i;
+            for (; path_[child].parent_ != NO_PARENT; child = path_[child].parent_){
+                slot(path_[child]) = std::move(slot(path_[path_[child].parent_]));
+            }
+            slot(path_[child]) = std::move(newItem);
+#ifdef CUCKOO_HASH_STATISTICS
+            if (stats_.evictionChains_.size() <= node.depth_){
+                stats_.evictionChains_.resize(node.depth_ + 1);
+            }
+            ++stats_.evictionChains_[node.depth_];
+#endif
+            return true;
+        }
+        if (node.depth_ == maxDepth){
+            continue;
+        }
+        size_t itemHash1 = getHash1(item.key_);
+        PathNode next{!node.table2_, node.table2_ ? itemHash1 % numBuckets_ : getHash2(itemHash1) % numBuckets_, i, node.depth_ + 1};
+        // A slot already on a path is reached at least as fast the other way,
+        // and visiting it again would move an item twice
+        bool seen = std::any_of(path_.begin(), path_.end(), [&next](const PathNode &other){
+            return other.table2_ == next.table2_ and other.index_ == next.index_;
+        });
+        if (!seen){
+            path_.push_back(next);
+        }
+    }
+#ifdef CUCKOO_HASH_STATISTICS
+    ++stats_.failedPaths_;
+#endif
+    return false;
+}
+
+template <typename key_t, typename value_t, typename Hash>
+bool CuckooHashMap<key_t, value_t, Hash>::place(Item& item){
+    // Leaves item untouched if it does not fit
+    if (cuckooPath(item, getHash1(item.key_))){
+        return true;
+    }
+    if (stashSize_ < STASH_SIZE){
+#ifdef CUCKOO_HASH_STATISTICS
+        ++stats_.stashed_;
+#endif
+        stash_[stashSize_++] = std::move(item);
         return true;
-    } else {
-        // Only compute hash2 if not found in hash1. Hashing is expensive
-        size_t hash2 = getHash2(hash1);
-        Item &item2 = table2_[hash2 % numBuckets_];
-        return item2.valid_ and item2.key_ == key;
     }
     return false;
 }
 
-template <typename key_t, typename value_t>
-void CuckooHashMap<key_t, value_t>::insert(const key_t& key, const value_t& value, bool updateValues){
-    key_t keyCopy = key;
-    value_t valueCopy = value;
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::drainStash(){
+    // Erasing freed a slot, move back any stashed item that now fits directly
+    for (size_t i = 0; i < stashSize_;){
+        size_t hash1 = getHash1(stash_[i].key_);
+        Item &item1 = table1_[hash1 % numBuckets_];
+        Item &item2 = table2_[getHash2(hash1) % numBuckets_];
+        Item *free = !item1.valid_ ? &item1 : !item2.valid_ ? &item2 : nullptr;
+        if (free){
+            *free = std::move(stash_[i]);
+            stash_[i] = std::move(stash_[--stashSize_]);
+            stash_[stashSize_].valid_ = false;
+        } else {
+            ++i;
+        }
+    }
+}
 
-    Item newItem = Item(keyCopy, valueCopy); // Copy constructor is needed. 
-    if (contains(key)) {
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::insertItem(Item& newItem, bool updateValues){
+    if (place(newItem)){
+        if(updateValues){
+            ++size_;
+            maxLoop_ = 3*size_t(ceil(log(size_) / log(1 + epsilon_))) + 1;
+        }
         return;
+    }
+    // No path and the stash is full. Rehash and insert the new item.
+    if (updateValues){
+        resize(numBuckets_ * 2);
     } else {
-        for (size_t loops = 0; loops < maxLoop_; ++loops){
-            size_t h1 = getHash1(newItem.key_);
-            // Empty spot, insert and finish
-            if (!table1_[h1%numBuckets_].valid_){
-                table1_[h1%numBuckets_] = newItem;
-                if(updateValues){
-                    ++size_;
-                    maxLoop_ = 3*size_t(ceil(log(size_) / log(1 + epsilon_))) + 1;
-                }
-                return;
-            }
-            else {
-                std::swap(newItem, table1_[h1 % numBuckets_]);
-            }
-            size_t h2 = getHash2(getHash1(newItem.key_)); // This is slow!
-            if (!table2_[h2 % numBuckets_].valid_){
-                table2_[h2 % numBuckets_] = newItem;
-                if(updateValues){
-                    ++size_;
-                    maxLoop_ = 3*size_t(ceil(log(size_) / log(1 + epsilon_))) + 1;
-                }
-                return;
-            } else {
-                std::swap(newItem, table2_[h2 % numBuckets_]);
-            }
-        }
-        // Rehash and insert the new item.
         rehash(numBuckets_ * 2);
-        insert(newItem.key_, newItem.value_, true);
     }
-    return;
+    insertItem(newItem, updateValues);
 }
 
-template <typename key_t, typename value_t>
-void CuckooHashMap<key_t, value_t>::insert(const key_t& key, const value_t& value){
-    insert(key, value, true);
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::insert(const key_t& key, const value_t& value){
+    try_emplace(key, value);
 }
 
-template <typename key_t, typename value_t>
-void CuckooHashMap<key_t, value_t>::erase(const key_t& key){
-    if (contains(key)){
-        size_t hash1 = getHash1(key);
-        Item &item1 = table1_[hash1 % numBuckets_];
-        if (item1.valid_ and item1.key_ == key) [[likely]]{
-            item1.valid_ = false;
-        } else [[unlikely]]{
-            // Only compute hash2 if not found in hash1. Hashing is expensive
-            size_t hash2 = getHash2(hash1);
-            Item &item2 = table2_[hash2 % numBuckets_];
-            if(item2.valid_ and item2.key_ == key){
-                item2.valid_ = false;
-            }
+template <typename key_t, typename value_t, typename Hash>
+template <typename K, typename... Args>
+bool CuckooHashMap<key_t, value_t, Hash>::try_emplace(K&& key, Args&&... args){
+    if (findItem(key)) {
+        return false;
+    }
+    Item newItem(std::in_place, std::forward<K>(key), std::forward<Args>(args)...);
+    insertItem(newItem, true);
+    if (oldTable1_){
+        migrate(rehashStep_);
+    }
+    return true;
+}
+
+template <typename key_t, typename value_t, typename Hash>
+template <typename... Args>
+bool CuckooHashMap<key_t, value_t, Hash>::emplace(Args&&... args){
+    value_type pair(std::forward<Args>(args)...);
+    return try_emplace(std::move(pair.first), std::move(pair.second));
+}
+
+template <typename key_t, typename value_t, typename Hash>
+template <typename K, typename V>
+bool CuckooHashMap<key_t, value_t, Hash>::insert_or_assign(K&& key, V&& value){
+    if (Item *item = findItem(key)) {
+        item->value_ = std::forward<V>(value);
+        return false;
+    }
+    return try_emplace(std::forward<K>(key), std::forward<V>(value));
+}
+
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::erase(const key_t& key){
+    eraseItem(findItem(key));
+}
+
+template <typename key_t, typename value_t, typename Hash>
+template <typename K> requires TransparentHashPolicy<Hash, key_t, K>
+void CuckooHashMap<key_t, value_t, Hash>::erase(const K& key){
+    eraseItem(findItem(key));
+}
+
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::eraseItem(Item *item){
+    if (item){
+        if (item >= stash_ and item < stash_ + stashSize_) [[unlikely]]{
+            *item = std::move(stash_[--stashSize_]);
+            stash_[stashSize_].valid_ = false;
+        } else {
+            item->valid_ = false;
+        }
+        if (stashSize_ > 0){
+            drainStash();
         }
         // Find the new maximum loop size
         --size_;
         maxLoop_ = 3*size_t(ceil(log(size_) / log(1 + epsilon_)));
 
-        // Check if resizing is needed. Critical threshold is (1+e)n/4
-        if (downsizeThresh_ > loadFactor())
-        {
-            rehash(numBuckets_ / 2);
+        if (oldTable1_){
+            migrate(rehashStep_);
+        } else if (downsizeThresh_ > loadFactor() and numBuckets_ > 2) {
+            // Check if resizing is needed. Critical threshold is (1+e)n/4
+            resize(numBuckets_ / 2);
         }
     }
     return;
 }
 
-template <typename key_t, typename value_t>
-value_t& CuckooHashMap<key_t, value_t>::lookup(const key_t& key)  const {
+template <typename key_t, typename value_t, typename Hash>
+value_t& CuckooHashMap<key_t, value_t, Hash>::lookup(const key_t& key)  const {
     // Assume that exists has been called
-    size_t hash1 = getHash1(key);
-    Item& item1 = table1_[hash1 % numBuckets_];
-    if (item1.valid_ and item1.key_ == key)
-    {
-        return item1.value_;
-    } else {
-        size_t hash2 = getHash2(hash1);
-        Item &item2 = table2_[hash2 % numBuckets_];
-        // If the key is not in the table, this is wrong!
-        return item2.value_;
+    if (Item *item = findItem(key)){
+        return item->value_;
+    }
+    // If the key is not in the table, this is wrong!
+    return table2_[getHash2(getHash1(key)) % numBuckets_].value_;
+}
+
+template <typename key_t, typename value_t, typename Hash>
+template <typename K> requires TransparentHashPolicy<Hash, key_t, K>
+value_t& CuckooHashMap<key_t, value_t, Hash>::lookup(const K& key)  const {
+    if (Item *item = findItem(key)){
+        return item->value_;
+    }
+    return table2_[getHash2(getHash1(key)) % numBuckets_].value_;
+}
+
+template <typename key_t, typename value_t, typename Hash>
+template <typename K> requires TransparentHashPolicy<Hash, key_t, K>
+bool CuckooHashMap<key_t, value_t, Hash>::contains(const K& key) const {
+    return findItem(key) != nullptr;
+}
+
+template <typename key_t, typename value_t, typename Hash>
+template <typename F>
+void CuckooHashMap<key_t, value_t, Hash>::probeBatch(std::span<const key_t> keys, F found) const {
+    size_t index1[BATCH_SIZE];
+    size_t index2[BATCH_SIZE];
+    for (size_t start = 0; start < keys.size(); start += BATCH_SIZE){
+        size_t count = std::min(BATCH_SIZE, keys.size() - start);
+        // Hash every key first so the loads of all candidate slots are in flight together
+        for (size_t i = 0; i < count; ++i){
+            size_t hash1 = getHash1(keys[start + i]);
+            index1[i] = hash1 % numBuckets_;
+            index2[i] = getHash2(hash1) % numBuckets_;
+            __builtin_prefetch(table1_ + index1[i]);
+            __builtin_prefetch(table2_ + index2[i]);
+        }
+        for (size_t i = 0; i < count; ++i){
+            const key_t &key = keys[start + i];
+            Item *item1 = table1_ + index1[i];
+            Item *item2 = table2_ + index2[i];
+            if (item1->valid_ and item1->key_ == key){
+                countProbes(1, 1);
+                found(start + i, item1);
+                continue;
+            }
+            countProbes(1, 2);
+            if (item2->valid_ and item2->key_ == key){
+                found(start + i, item2);
+            } else {
+                found(start + i, (oldTable1_ or stashSize_ > 0) ? findOverflow(key, getHash1(key)) : nullptr);
+            }
+        }
+    }
+}
+
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::containsBatch(std::span<const key_t> keys, std::span<bool> found) const {
+    if (found.size() < keys.size()){
+        throw std::invalid_argument("containsBatch needs an output for every key");
     }
+    probeBatch(keys, [&found](size_t i, Item *item){ found[i] = item != nullptr; });
+}
+
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::lookupBatch(std::span<const key_t> keys, std::span<value_t*> values) const {
+    if (values.size() < keys.size()){
+        throw std::invalid_argument("lookupBatch needs an output for every key");
+    }
+    probeBatch(keys, [&values](size_t i, Item *item){ values[i] = item ? &item->value_ : nullptr; });
+}
+
+template <typename key_t, typename value_t, typename Hash>
+uint64_t CuckooHashMap<key_t, value_t, Hash>::hashCheck() {
+    Hash hash;
+    return hash.hash1(key_t{}) ^ hash.hash2(0x9e3779b97f4a7c15ULL);
 }
 
-template <typename key_t, typename value_t>
-value_t& CuckooHashMap<key_t, value_t>::operator[](const key_t& key) {
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::save(const std::string &path) const requires TRIVIAL_ITEMS {
+    static_assert(alignof(Item) <= alignof(SnapshotHeader), "Items must stay aligned after the header");
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out){
+        throw std::runtime_error("Cannot open " + path + " for writing");
+    }
+    SnapshotHeader header{};
+    std::memcpy(header.magic_, SNAPSHOT_MAGIC, sizeof(header.magic_));
+    header.itemSize_ = sizeof(Item);
+    header.itemAlign_ = alignof(Item);
+    header.hashCheck_ = hashCheck();
+    header.numBuckets_ = numBuckets_;
+    header.size_ = size_;
+    header.stashSize_ = stashSize_;
+    header.oldNumBuckets_ = oldNumBuckets_;
+    header.migrated_ = migrated_;
+    header.rehashStep_ = rehashStep_;
+    header.maxLoop_ = maxLoop_;
+    header.maxPathDepth_ = maxPathDepth_;
+    header.epsilon_ = epsilon_;
+    header.downsizeThresh_ = downsizeThresh_;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    auto write = [&out](const Item *items, size_t count){
+        out.write(reinterpret_cast<const char*>(items), count * sizeof(Item));
+    };
+    write(table1_, numBuckets_);
+    write(table2_, numBuckets_);
+    write(stash_, STASH_SIZE);
+    write(oldTable1_, oldNumBuckets_);
+    write(oldTable2_, oldNumBuckets_);
+    if (!out.flush()){
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+template <typename key_t, typename value_t, typename Hash>
+CuckooHashMap<key_t, value_t, Hash> CuckooHashMap<key_t, value_t, Hash>::open(const std::string &path) requires TRIVIAL_ITEMS {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0){
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 or size_t(info.st_size) < sizeof(SnapshotHeader)){
+        ::close(fd);
+        throw std::invalid_argument(path + " is not a CuckooHashMap snapshot");
+    }
+    // A private mapping: pages are read on first use and writes only change this process's copy
+    size_t size = info.st_size;
+    void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED){
+        throw std::runtime_error("Cannot map " + path);
+    }
+    const SnapshotHeader &header = *static_cast<const SnapshotHeader*>(mapping);
+    if (std::memcmp(header.magic_, SNAPSHOT_MAGIC, sizeof(header.magic_)) != 0 or header.itemSize_ != sizeof(Item)
+        or header.itemAlign_ != alignof(Item) or header.hashCheck_ != hashCheck()){
+        munmap(mapping, size);
+        throw std::invalid_argument(path + " was not saved by this type of CuckooHashMap");
+    }
+    // The header is only trusted once every table it describes fits the file exactly.
+    // Each table is bounded by the file before adding, so numItems cannot wrap.
+    size_t fileItems = (size - sizeof(SnapshotHeader)) / sizeof(Item);
+    bool fits = (size - sizeof(SnapshotHeader)) % sizeof(Item) == 0 and header.numBuckets_ <= fileItems / 2
+                and header.oldNumBuckets_ <= fileItems / 2
+                and 2 * header.numBuckets_ + STASH_SIZE + 2 * header.oldNumBuckets_ == fileItems;
+    size_t numItems = fits ? fileItems : 0;
+    if (!fits or header.numBuckets_ == 0 or header.stashSize_ > STASH_SIZE
+        or header.migrated_ > 2 * header.oldNumBuckets_ or header.size_ > numItems){
+        munmap(mapping, size);
+        throw std::invalid_argument(path + " is a corrupt CuckooHashMap snapshot");
+    }
+    return CuckooHashMap(mapping, size);
+}
+
+template <typename key_t, typename value_t, typename Hash>
+value_t& CuckooHashMap<key_t, value_t, Hash>::operator[](const key_t& key) {
     return lookup(key);
 }
 
-template <typename key_t, typename value_t>
-void CuckooHashMap<key_t, value_t>::printToStream(ostream& out) const {
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::printToStream(ostream& out) const {
     out << "Table 1: [ ";
     for (Item *item = table1_; item < table1_ + numBuckets_; ++item)
     {
@@ -244,68 +766,68 @@ void CuckooHashMap<key_t, value_t>::printToStream(ostream& out) const {
             out << "(-:-) ";
         }
     }
+    out << "]\nStash: [ ";
+    for (Item *item = stash_; item < stash_ + stashSize_; ++item){
+        out << "(" << item->key_ << ": " << item->value_ << ") ";
+    }
     out << "]\n Epsilon: " << epsilon_ << " Num Buckets: " << numBuckets_ << " Size: " << size_ << " Max Loops: " << maxLoop_;
+    if (oldTable1_){
+        out << " Rehashing from " << oldNumBuckets_ << " buckets, " << migrated_ << " slots moved";
+    }
 }
-template <typename key_t, typename value_t>
-std::string CuckooHashMap<key_t, value_t>::to_string() const {
+template <typename key_t, typename value_t, typename Hash>
+std::string CuckooHashMap<key_t, value_t, Hash>::to_string() const {
     std::stringstream ss;
     printToStream(ss);
     return ss.str();
 }
 
 
-template <typename key_t, typename value_t>
-CuckooHashMap<key_t, value_t>::Item::Item():valid_{false}{
+template <typename key_t, typename value_t, typename Hash>
+CuckooHashMap<key_t, value_t, Hash>::Item::Item():valid_{false}{
 }
 
-template <typename key_t, typename value_t>
-CuckooHashMap<key_t, value_t>::Item::Item(key_t& key, value_t& value):
-key_{key}, value_{value},valid_{true}{}
+template <typename key_t, typename value_t, typename Hash>
+template <typename K, typename... Args>
+CuckooHashMap<key_t, value_t, Hash>::Item::Item(std::in_place_t, K&& key, Args&&... args):
+key_(std::forward<K>(key)), value_(std::forward<Args>(args)...),valid_{true}{}
 
-template <typename key_t, typename value_t>
-ostream& operator<<(ostream& os, const CuckooHashMap<key_t, value_t>& ch){
+template <typename key_t, typename value_t, typename Hash>
+ostream& operator<<(ostream& os, const CuckooHashMap<key_t, value_t, Hash>& ch){
     os << ch.to_string();
     return os;
 }
 
 // Iterator Functions
 
-template <typename key_t, typename value_t>
-typename CuckooHashMap<key_t, value_t>::ConstIterator CuckooHashMap<key_t, value_t>::begin() const {
-    return ConstIterator(0, numBuckets_, table1_, table2_);
+template <typename key_t, typename value_t, typename Hash>
+typename CuckooHashMap<key_t, value_t, Hash>::ConstIterator CuckooHashMap<key_t, value_t, Hash>::begin() const {
+    return ConstIterator(0, this);
 }
 
-template <typename key_t, typename value_t>
-typename CuckooHashMap<key_t, value_t>::ConstIterator CuckooHashMap<key_t, value_t>::end() const {
-    return ConstIterator(2 * numBuckets_, numBuckets_, table1_, table2_);
+template <typename key_t, typename value_t, typename Hash>
+typename CuckooHashMap<key_t, value_t, Hash>::ConstIterator CuckooHashMap<key_t, value_t, Hash>::end() const {
+    return ConstIterator(numSlots(), this);
 }
 
-template <typename key_t, typename value_t>
-CuckooHashMap<key_t, value_t>::ConstIterator::ConstIterator(size_t idx, size_t tableSize, Item* t1, Item* t2):
-    t1_{t1}, t2_{t2}, idx_{idx}, tableSize_{tableSize}{
+template <typename key_t, typename value_t, typename Hash>
+CuckooHashMap<key_t, value_t, Hash>::ConstIterator::ConstIterator(size_t idx, const CuckooHashMap *map):
+    map_{map}, idx_{idx}{
     iterateTable();
 }
 
-template <typename key_t, typename value_t>
-typename CuckooHashMap<key_t, value_t>::ConstIterator& CuckooHashMap<key_t, value_t>::ConstIterator::operator++() {
+template <typename key_t, typename value_t, typename Hash>
+typename CuckooHashMap<key_t, value_t, Hash>::ConstIterator& CuckooHashMap<key_t, value_t, Hash>::ConstIterator::operator++() {
     ++idx_;
     iterateTable();
     return *this;
 }
 
-template <typename key_t,typename value_t>
-void CuckooHashMap<key_t, value_t>::ConstIterator::iterateTable(){
-    // First Table
-    while (idx_ < tableSize_) {
-        if (t1_[idx_].valid_){
-            return;
-        } else {
-            ++idx_;
-        }
-    }
-    // Second Table
-    while (idx_ < 2 * tableSize_){
-        if (t2_[idx_-tableSize_].valid_){
+template <typename key_t, typename value_t, typename Hash>
+void CuckooHashMap<key_t, value_t, Hash>::ConstIterator::iterateTable(){
+    // Both tables, then the stash, then the old tables of an unfinished rehash
+    while (idx_ < map_->numSlots()) {
+        if (map_->itemAt(idx_)->valid_){
             return;
         } else {
             ++idx_;
@@ -313,29 +835,24 @@ void CuckooHashMap<key_t, value_t>::ConstIterator::iterateTable(){
     }
 }
 
-template <typename key_t, typename value_t>
-typename CuckooHashMap<key_t, value_t>::ConstIterator::value_type CuckooHashMap<key_t, value_t>::ConstIterator::operator*() const{
-    if (idx_ < tableSize_) {
-        return {t1_[idx_].key_, t1_[idx_].value_};
-
-    } else {
-        return {t2_[idx_ - tableSize_].key_, t2_[idx_-tableSize_].value_};
-
-    }
+template <typename key_t, typename value_t, typename Hash>
+typename CuckooHashMap<key_t, value_t, Hash>::ConstIterator::value_type CuckooHashMap<key_t, value_t, Hash>::ConstIterator::operator*() const{
+    Item *item = map_->itemAt(idx_);
+    return {item->key_, item->value_};
 }
 
-template <typename key_t, typename value_t>
-bool CuckooHashMap<key_t, value_t>::ConstIterator::operator==(const ConstIterator& other) const {
-    return (idx_ == other.idx_) and (t1_ == other.t1_) and (t2_ == other.t2_);
+template <typename key_t, typename value_t, typename Hash>
+bool CuckooHashMap<key_t, value_t, Hash>::ConstIterator::operator==(const ConstIterator& other) const {
+    return (idx_ == other.idx_) and (map_ == other.map_);
 }
 
-template <typename key_t, typename value_t>
-bool CuckooHashMap<key_t, value_t>::ConstIterator::operator!=(const ConstIterator& other) const{
+template <typename key_t, typename value_t, typename Hash>
+bool CuckooHashMap<key_t, value_t, Hash>::ConstIterator::operator!=(const ConstIterator& other) const{
     return !(*this == other);
 }
 
-template <typename key_t, typename value_t>
-typename CuckooHashMap<key_t, value_t>::ConstIterator::pointer CuckooHashMap<key_t, value_t>::ConstIterator::operator->() const{
+template <typename key_t, typename value_t, typename Hash>
+typename CuckooHashMap<key_t, value_t, Hash>::ConstIterator::pointer CuckooHashMap<key_t, value_t, Hash>::ConstIterator::operator->() const{
     return &(**this);
 }
 
@@ -343,63 +860,73 @@ typename CuckooHashMap<key_t, value_t>::ConstIterator::pointer CuckooHashMap<key
  * Cuckoo Hash Set *
  *******************/
 
-template <typename T>
-CuckooHashSet<T>::CuckooHashSet():valid1_{false, false}, valid2_{false, false},
-    epsilon_{0.4}, size_{0}, table1_{new T[2]}, table2_{new T[2]}, maxLoop_{1},
+template <typename T, typename Hash>
+CuckooHashSet<T, Hash>::CuckooHashSet():
+    epsilon_{0.4}, size_{0}, table1_{new Group[numGroups(2)]}, table2_{new Group[numGroups(2)]}, maxLoop_{1},
     numBuckets_{2}, downsizeThresh_{0.2}{
     // Nothing here
 }
 
-template <typename T>
-CuckooHashSet<T>::CuckooHashSet(double epsilon, float downsizeThresh):
-    valid1_{false, false}, valid2_{false, false}, epsilon_{epsilon}, 
-    size_{0}, table1_{new T[2]}, table2_{new T[2]}, maxLoop_{1},
+template <typename T, typename Hash>
+CuckooHashSet<T, Hash>::CuckooHashSet(double epsilon, float downsizeThresh):
+    epsilon_{epsilon}, 
+    size_{0}, table1_{new Group[numGroups(2)]}, table2_{new Group[numGroups(2)]}, maxLoop_{1},
     numBuckets_{2}, downsizeThresh_{downsizeThresh} {
 
 }
 
-template <typename T>
-CuckooHashSet<T>::~CuckooHashSet(){
+template <typename T, typename Hash>
+CuckooHashSet<T, Hash>::~CuckooHashSet(){
     delete[] table1_;
     delete[] table2_;
 }
 
-template <typename T>
-size_t CuckooHashSet<T>::getHash1(const T& key) const {
-    return hash1_(key);
+template <typename T, typename Hash>
+size_t CuckooHashSet<T, Hash>::getHash1(const T& key) const {
+    return hash_.hash1(key);
 }
 
-template <typename T>
-size_t CuckooHashSet<T>::getHash2(size_t hash1) const{
-    string key_str;
-    for (size_t byte = 0; byte < 8; ++byte)
-    {
-        unsigned char c = hash1 & 255;
-        key_str += c;
-        hash1 >>= 8;
+template <typename T, typename Hash>
+size_t CuckooHashSet<T, Hash>::getHash2(size_t hash1) const{
+    return hash_.hash2(hash1);
+}
+
+template <typename T, typename Hash>
+size_t CuckooHashSet<T, Hash>::numGroups(size_t numBuckets){
+    return (numBuckets + GROUP_SIZE - 1) / GROUP_SIZE;
+}
+
+template <typename T, typename Hash>
+bool CuckooHashSet<T, Hash>::isValid(const Group *table, size_t idx){
+    return (table[idx / GROUP_SIZE].valid_ >> (idx % GROUP_SIZE)) & 1;
+}
+
+template <typename T, typename Hash>
+void CuckooHashSet<T, Hash>::setValid(Group *table, size_t idx, bool valid){
+    uint64_t bit = uint64_t(1) << (idx % GROUP_SIZE);
+    if (valid){
+        table[idx / GROUP_SIZE].valid_ |= bit;
+    } else {
+        table[idx / GROUP_SIZE].valid_ &= ~bit;
     }
-    return  hash2_(key_str);
 }
 
-template <typename T>
-double CuckooHashSet<T>::loadFactor() const {
+template <typename T, typename Hash>
+T& CuckooHashSet<T, Hash>::keyAt(Group *table, size_t idx){
+    return table[idx / GROUP_SIZE].keys_[idx % GROUP_SIZE];
+}
+
+template <typename T, typename Hash>
+double CuckooHashSet<T, Hash>::loadFactor() const {
     return double(size_) / (2 * numBuckets_);
 }
 
-template <typename T>
-void CuckooHashSet<T>::rehash(size_t numBuckets){
+template <typename T, typename Hash>
+void CuckooHashSet<T, Hash>::rehash(size_t numBuckets){
     vector<T> allKeys;
-    for (size_t i = 0; i < numBuckets_;++i)
+    for (const T& key : *this)
     {
-        if (valid1_[i]){
-            allKeys.push_back(table1_[i]);
-        }
-    }
-    for (size_t i = 0; i < numBuckets_;++i)
-    {
-        if (valid2_[i]){
-            allKeys.push_back(table2_[i]);
-        }
+        allKeys.push_back(key);
     }
 
     // Clear old tables
@@ -408,12 +935,8 @@ void CuckooHashSet<T>::rehash(size_t numBuckets){
 
     // Rehash into new table;
     numBuckets_ = numBuckets;
-    table1_ = new T[numBuckets_];
-    table2_ = new T[numBuckets_];
-    valid1_.resize(numBuckets_);
-    valid2_.resize(numBuckets_);
-    std::fill(valid1_.begin(), valid1_.end(), false);
-    std::fill(valid2_.begin(), valid2_.end(), false);
+    table1_ = new Group[numGroups(numBuckets_)];
+    table2_ = new Group[numGroups(numBuckets_)];
 
     // Re-insert all items
     for (const T& key : allKeys)
@@ -422,9 +945,8 @@ void CuckooHashSet<T>::rehash(size_t numBuckets){
     }
 }
 
-template<typename T>
-void CuckooHashSet<T>::insert(const T&key, bool updateValues){
-    T keyCopy = key;
+template <typename T, typename Hash>
+void CuckooHashSet<T, Hash>::insert(const T&key, bool updateValues){
     T newKey = key;
     if (contains(key))
     {
@@ -435,9 +957,9 @@ void CuckooHashSet<T>::insert(const T&key, bool updateValues){
         for (size_t loops = 0; loops < maxLoop_; ++loops){
             size_t h1 = getHash1(newKey);
             // Empty spot, insert and finish
-            if (!valid1_[h1%numBuckets_]){
-                table1_[h1%numBuckets_] = newKey;
-                valid1_[h1 % numBuckets_] = true;
+            if (!isValid(table1_, h1 % numBuckets_)){
+                keyAt(table1_, h1 % numBuckets_) = newKey;
+                setValid(table1_, h1 % numBuckets_, true);
                 if (updateValues)
                 {
                     ++size_;
@@ -445,57 +967,57 @@ void CuckooHashSet<T>::insert(const T&key, bool updateValues){
                 }
                 return;
             } else {
-                std::swap(newKey, table1_[h1 % numBuckets_]);
+                std::swap(newKey, keyAt(table1_, h1 % numBuckets_));
             }
-            size_t h2 = getHash2(getHash1(newKey)); // This is slow!
-            if (!valid2_[h2 % numBuckets_]){
-                table2_[h2 % numBuckets_] = newKey;
-                valid2_[h2 % numBuckets_] = true;
+            size_t h2 = getHash2(getHash1(newKey));
+            if (!isValid(table2_, h2 % numBuckets_)){
+                keyAt(table2_, h2 % numBuckets_) = newKey;
+                setValid(table2_, h2 % numBuckets_, true);
                 if(updateValues){
                     ++size_;
                     maxLoop_ = 3*size_t(ceil(log(size_) / log(1 + epsilon_))) + 1;
                 }
                 return;
             } else {
-                std::swap(newKey, table2_[h2 % numBuckets_]);
+                std::swap(newKey, keyAt(table2_, h2 % numBuckets_));
             }
         }
         // Rehash and insert the new item.
         rehash(numBuckets_ * 2);
-        insert(newKey, true);
+        insert(newKey, updateValues);
     }
     return;
 }
 
-template<typename T>
-bool CuckooHashSet<T>::empty() const {
+template <typename T, typename Hash>
+bool CuckooHashSet<T, Hash>::empty() const {
     return size_ == 0;
 }
 
-template <typename T>
-size_t CuckooHashSet<T>::size() const {
-    return size_ == 0;
+template <typename T, typename Hash>
+size_t CuckooHashSet<T, Hash>::size() const {
+    return size_;
 }
 
-template <typename T>
-void CuckooHashSet<T>::insert(const T &key){
+template <typename T, typename Hash>
+void CuckooHashSet<T, Hash>::insert(const T &key){
     insert(key, true);
 }
 
-template <typename T>
-void CuckooHashSet<T>::erase(const T& key){
+template <typename T, typename Hash>
+void CuckooHashSet<T, Hash>::erase(const T& key){
     if (contains(key)){
         size_t hash1 = getHash1(key);
         size_t table1Ind = hash1%numBuckets_;
-        if (valid1_[table1Ind] and table1_[table1Ind] == key) [[likely]]{
-            valid1_[table1Ind] = false;
+        if (isValid(table1_, table1Ind) and keyAt(table1_, table1Ind) == key) [[likely]]{
+            setValid(table1_, table1Ind, false);
         } else [[unlikely]]{
             // Only compute hash2 if not found in hash1. Hashing is expensive
             size_t hash2 = getHash2(hash1);
             size_t table2Ind = hash2 % numBuckets_;
-            if (valid2_[table2Ind] and table2_[table2Ind] == key)
+            if (isValid(table2_, table2Ind) and keyAt(table2_, table2Ind) == key)
             {
-                valid2_[table2Ind] = false;
+                setValid(table2_, table2Ind, false);
             }
         }
         // Find the new maximum loop size
@@ -503,7 +1025,7 @@ void CuckooHashSet<T>::erase(const T& key){
         maxLoop_ = 3*size_t(ceil(log(size_) / log(1 + epsilon_)));
 
         // Check if resizing is needed. Critical threshold is (1+e)n/4
-        if (downsizeThresh_ > loadFactor())
+        if (downsizeThresh_ > loadFactor() and numBuckets_ > 2)
         {
             rehash(numBuckets_ / 2);
         }
@@ -511,38 +1033,60 @@ void CuckooHashSet<T>::erase(const T& key){
     return;
 }
 
-template <typename T>
-bool CuckooHashSet<T>::contains(const T& key)const {
+template <typename T, typename Hash>
+bool CuckooHashSet<T, Hash>::contains(const T& key)const {
     size_t hash1 = getHash1(key);
     size_t ind1 = hash1 % numBuckets_;
-    if (valid1_[ind1] and table1_[ind1] == key) {
+    if (isValid(table1_, ind1) and keyAt(table1_, ind1) == key) {
         return true;
     } else {
-        size_t hash2 = getHash2(hash1) % numBuckets_;
-        size_t ind2 = hash2 % numBuckets_;
-        return valid2_[ind2] and table2_[ind2] == key;
+        size_t ind2 = getHash2(hash1) % numBuckets_;
+        return isValid(table2_, ind2) and keyAt(table2_, ind2) == key;
     }
 }
 
-template<typename T>
-void CuckooHashSet<T>::clear(){
+template <typename T, typename Hash>
+void CuckooHashSet<T, Hash>::containsBatch(std::span<const T> keys, std::span<bool> found) const {
+    if (found.size() < keys.size()){
+        throw std::invalid_argument("containsBatch needs an output for every key");
+    }
+    size_t index1[BATCH_SIZE];
+    size_t index2[BATCH_SIZE];
+    for (size_t start = 0; start < keys.size(); start += BATCH_SIZE){
+        size_t count = std::min(BATCH_SIZE, keys.size() - start);
+        // Hash every key first so the loads of all candidate slots are in flight together
+        for (size_t i = 0; i < count; ++i){
+            size_t hash1 = getHash1(keys[start + i]);
+            index1[i] = hash1 % numBuckets_;
+            index2[i] = getHash2(hash1) % numBuckets_;
+            __builtin_prefetch(table1_ + index1[i] / GROUP_SIZE);
+            __builtin_prefetch(table2_ + index2[i] / GROUP_SIZE);
+        }
+        for (size_t i = 0; i < count; ++i){
+            const T &key = keys[start + i];
+            found[start + i] = (isValid(table1_, index1[i]) and keyAt(table1_, index1[i]) == key) or
+                               (isValid(table2_, index2[i]) and keyAt(table2_, index2[i]) == key);
+        }
+    }
+}
+
+template <typename T, typename Hash>
+void CuckooHashSet<T, Hash>::clear(){
     delete[] table1_;
     delete[] table2_;
-    table1_ = new T[2];
-    table2_ = new T[2];
-    valid1_ = {false, false};
-    valid2_ = {false, false};
+    table1_ = new Group[numGroups(2)];
+    table2_ = new Group[numGroups(2)];
     numBuckets_ = 2;
     maxLoop_ = 1;
     size_ = 0;
 }
 
-template <typename T>
-void CuckooHashSet<T>::printToStream(ostream &out) const{
+template <typename T, typename Hash>
+void CuckooHashSet<T, Hash>::printToStream(ostream &out) const{
     out << "Table 1: [ ";
     for (size_t i = 0; i < numBuckets_; ++i) {
-        if (valid1_[i]){
-            out << table1_[i] << ", ";
+        if (isValid(table1_, i)){
+            out << keyAt(table1_, i) << ", ";
         } else {
             out << " ,";
         }
@@ -551,8 +1095,8 @@ void CuckooHashSet<T>::printToStream(ostream &out) const{
 
     for (size_t i = 0; i < numBuckets_; ++i)
     {
-       if (valid2_[i]){
-            out << table2_[i] << ", ";
+       if (isValid(table2_, i)){
+            out << keyAt(table2_, i) << ", ";
         } else {
             out << " ,";
         }
@@ -560,86 +1104,85 @@ void CuckooHashSet<T>::printToStream(ostream &out) const{
     out << "]\n Epsilon: " << epsilon_ << " Num Buckets: " << numBuckets_ << " Size: " << size_ << " Max Loops: " << maxLoop_;
 }
 
-template <typename T>
-std::string CuckooHashSet<T>::to_string() const {
+template <typename T, typename Hash>
+std::string CuckooHashSet<T, Hash>::to_string() const {
     std::stringstream ss;
     printToStream(ss);
     return ss.str();
 }
 
-template <typename T>
-typename CuckooHashSet<T>::ConstIterator CuckooHashSet<T>::begin() const {
-    return ConstIterator(0, table1_, table2_, valid1_, valid2_);
+template <typename T, typename Hash>
+typename CuckooHashSet<T, Hash>::ConstIterator CuckooHashSet<T, Hash>::begin() const {
+    return ConstIterator(0, numBuckets_, table1_, table2_);
 }
 
-template <typename T>
-typename CuckooHashSet<T>::ConstIterator CuckooHashSet<T>::end() const {
-    return ConstIterator(2 * numBuckets_, table1_, table2_, valid1_, valid2_);
+template <typename T, typename Hash>
+typename CuckooHashSet<T, Hash>::ConstIterator CuckooHashSet<T, Hash>::end() const {
+    return ConstIterator(2 * numBuckets_, numBuckets_, table1_, table2_);
 }
 
-template <typename T>
-CuckooHashSet<T>::ConstIterator::ConstIterator(size_t idx, T* t1, T* t2, const vector<bool>& valid1, const vector<bool>& valid2):
-    v1_{valid1}, v2_{valid2},idx_{idx},t1_{t1}, t2_{t2}{
+template <typename T, typename Hash>
+CuckooHashSet<T, Hash>::ConstIterator::ConstIterator(size_t idx, size_t tableSize, Group* t1, Group* t2):
+    idx_{idx}, tableSize_{tableSize}, t1_{t1}, t2_{t2}{
     iterateTable();
 }
 
-template <typename T>
-typename CuckooHashSet<T>::ConstIterator& CuckooHashSet<T>::ConstIterator::operator++() {
+template <typename T, typename Hash>
+typename CuckooHashSet<T, Hash>::ConstIterator& CuckooHashSet<T, Hash>::ConstIterator::operator++() {
     ++idx_;
     iterateTable();
     return *this;
 }
 
-template <typename T>
-void CuckooHashSet<T>::ConstIterator::iterateTable(){
-    // First Table
-    size_t tableSize = v1_.size(); // Table size is the size of the valid vec
-    while (idx_ < tableSize)
+template <typename T, typename Hash>
+void CuckooHashSet<T, Hash>::ConstIterator::iterateTable(){
+    while (idx_ < 2 * tableSize_)
     {
-        if (v1_[idx_]){
+        bool second = idx_ >= tableSize_;
+        size_t slot = second ? idx_ - tableSize_ : idx_;
+        // Bits past the end of the table are never set
+        const Group *table = second ? t2_ : t1_;
+        uint64_t mask = table[slot / GROUP_SIZE].valid_ >> (slot % GROUP_SIZE);
+        if (mask){
+            idx_ += std::countr_zero(mask);
             return;
-        } else {
-            ++idx_;
         }
-    }
-    // Second Table
-    while (idx_ < 2 * tableSize){
-        if (v2_[idx_-tableSize]){
-            return;
-        } else {
-            ++idx_;
+        // Rest of the group is empty. The last group of table 1 may be cut short.
+        idx_ += GROUP_SIZE - slot % GROUP_SIZE;
+        if (!second and idx_ > tableSize_){
+            idx_ = tableSize_;
         }
     }
+    idx_ = 2 * tableSize_;
 }
 
-template <typename T>
-typename CuckooHashSet<T>::ConstIterator::value_type CuckooHashSet<T>::ConstIterator::operator*() const{
-    size_t tableSize = v2_.size();
-    if (idx_ < tableSize)
+template <typename T, typename Hash>
+typename CuckooHashSet<T, Hash>::ConstIterator::value_type CuckooHashSet<T, Hash>::ConstIterator::operator*() const{
+    if (idx_ < tableSize_)
     {
-        return t1_[idx_];
+        return keyAt(t1_, idx_);
     } else {
-        return t2_[idx_ - tableSize];
+        return keyAt(t2_, idx_ - tableSize_);
     }
 }
 
-template <typename T>
-bool CuckooHashSet<T>::ConstIterator::operator==(const ConstIterator& other) const {
+template <typename T, typename Hash>
+bool CuckooHashSet<T, Hash>::ConstIterator::operator==(const ConstIterator& other) const {
     return (idx_ == other.idx_) and (t1_ == other.t1_) and (t2_ == other.t2_);
 }
 
-template <typename T>
-bool CuckooHashSet<T>::ConstIterator::operator!=(const ConstIterator& other) const{
+template <typename T, typename Hash>
+bool CuckooHashSet<T, Hash>::ConstIterator::operator!=(const ConstIterator& other) const{
     return !(*this == other);
 }
 
-template <typename T>
-typename CuckooHashSet<T>::ConstIterator::pointer CuckooHashSet<T>::ConstIterator::operator->() const{
+template <typename T, typename Hash>
+typename CuckooHashSet<T, Hash>::ConstIterator::pointer CuckooHashSet<T, Hash>::ConstIterator::operator->() const{
     return &(**this);
 }
 
-template <typename T>
-ostream& operator<<(ostream& os, const CuckooHashSet<T>& cs){
+template <typename T, typename Hash>
+ostream& operator<<(ostream& os, const CuckooHashSet<T, Hash>& cs){
     os << cs.to_string();
     return os;
 }
@@ -9,18 +9,54 @@
  * 
  */
 #include <cstddef>
+#include <cstdint>
+#include <algorithm>
 #include <string>
 #include <cmath>
 #include <vector>
 #include <iterator>
 #include <tuple>
+#include <span>
+#include <utility>
+#include <type_traits>
+
+#include "cuckoo-hash-policy.hpp"
 
 #ifndef CUCKOO_HASH_HPP_INCLUDED
 #define CUCKOO_HASH_HPP_INCLUDED
 
-template <typename key_t, typename value_t>
+/**
+ * @brief What a CuckooHashMap has done since it was built or since resetStats().
+ * Only collected if CUCKOO_HASH_STATISTICS is defined before including this
+ * file, otherwise the counters are compiled out.
+ */
+struct CuckooHashStats {
+    size_t lookups_ = 0; // Key searches, including the ones done by insert and erase
+    size_t probes_ = 0; // Slots compared by all searches
+    std::vector<size_t> evictionChains_; // [k] = items placed after moving k other items
+    size_t failedPaths_ = 0; // Searches that found no free slot within the longest allowed path
+    size_t stashed_ = 0; // Items placed in the stash
+    size_t rehashes_ = 0; // Full rehashes, each moves every item at once
+    double rehashSeconds_ = 0; // Total time spent in full rehashes
+    double maxRehashSeconds_ = 0;
+    size_t incrementalResizes_ = 0; // Resizes that move items a few at a time instead
+
+    // Current occupancy, filled in by stats()
+    size_t numBuckets_ = 0;
+    size_t table1Items_ = 0;
+    size_t table2Items_ = 0;
+    size_t stashItems_ = 0;
+    size_t oldTableItems_ = 0; // Items not yet moved by an incremental resize
+
+    double averageProbes() const { return lookups_ ? double(probes_) / lookups_ : 0; }
+};
+
+// Hash must satisfy CuckooHashPolicy<Hash, key_t>, see cuckoo-hash-policy.hpp
+template <typename key_t, typename value_t, typename Hash = MixHashPolicy<key_t>>
 class CuckooHashMap
 {
+    static_assert(CuckooHashPolicy<Hash, key_t>, "Hash must provide hash1(key) and hash2(hash1)");
+
   private:
     class ConstIterator;
 
@@ -30,28 +66,110 @@ class CuckooHashMap
         bool valid_; // Way to check if it is valid after deletions.
 
         Item(); // For invalid deleted items. 
-        Item(key_t &key, value_t &value); // For valid items. 
+        template <typename K, typename... Args>
+        Item(std::in_place_t, K &&key, Args&&... args); // For valid items, value_ is built from args
         Item(const Item &other) = default;
+        Item(Item &&other) = default;
+        Item &operator=(const Item &other) = default;
+        Item &operator=(Item &&other) = default; // Evictions move items
         ~Item() = default;
     };
 
+    // One slot on an eviction path found by the breadth first search
+    struct PathNode {
+        bool table2_;
+        size_t index_;
+        size_t parent_; // Index of the previous node, NO_PARENT for the key's own slots
+        size_t depth_;
+    };
+
+    static constexpr size_t NO_PARENT = size_t(-1);
+
+    // Items that could not be placed without a rehash. Checked after both tables.
+    static constexpr size_t STASH_SIZE = 4;
+
+    // save() and open() copy Items as raw bytes
+    static constexpr bool TRIVIAL_ITEMS = std::is_trivially_copyable_v<key_t> and std::is_trivially_copyable_v<value_t>;
+
+    // Start of a file written by save(). It is followed by table1_, table2_, all
+    // STASH_SIZE slots of stash_, oldTable1_ and oldTable2_, as raw Items.
+    struct alignas(64) SnapshotHeader {
+        char magic_[8];
+        uint64_t itemSize_;
+        uint64_t itemAlign_;
+        uint64_t hashCheck_; // Catches files written with a different hash policy
+        uint64_t numBuckets_;
+        uint64_t size_;
+        uint64_t stashSize_;
+        uint64_t oldNumBuckets_;
+        uint64_t migrated_;
+        uint64_t rehashStep_;
+        uint64_t maxLoop_;
+        uint64_t maxPathDepth_;
+        double epsilon_;
+        float downsizeThresh_;
+    };
+
+    static constexpr char SNAPSHOT_MAGIC[8] = "CUCKOO1";
+
     // Data
     Item* table1_;
     Item* table2_;
+    Item* stash_; // The first stashSize_ items are valid
+    size_t stashSize_;
+    Item* oldTable1_; // Tables being moved into table1_ and table2_, nullptr if no rehash is in progress
+    Item* oldTable2_;
+    size_t oldNumBuckets_;
+    size_t migrated_; // Slots of the old tables already moved, table 1 then table 2
+    size_t rehashStep_; // Items moved out of the old tables by each insert or erase, 0 to rehash all at once
     double epsilon_;
     size_t size_;
     size_t maxLoop_; // set to 3 log_1+e(n)
+    size_t maxPathDepth_; // Longest eviction path, 0 to use maxLoop_
     size_t numBuckets_;
-    std::hash<key_t> hash1_;
-    std::hash<std::string> hash2_;
+    Hash hash_;
     float downsizeThresh_;
+    std::vector<PathNode> path_; // Reused by every search to avoid allocating
+    void* mapping_; // Snapshot opened by open(), nullptr once no table points into it
+    size_t mappingSize_;
+#ifdef CUCKOO_HASH_STATISTICS
+    mutable CuckooHashStats stats_; // Lookups are const, but still counted
+#endif
 
     // Helper Functions
-    size_t getHash1(const key_t& key) const;
+    template <typename K>
+    size_t getHash1(const K& key) const;
     size_t getHash2(size_t hash1) const;
+    Item &slot(const PathNode &node) const;
+    template <typename K>
+    Item *findItem(const K& key) const;
+    template <typename K>
+    Item *findOverflow(const K& key, size_t hash1) const; // Old tables and stash
+    template <typename K>
+    Item *findInStash(const K& key) const;
+    Item *itemAt(size_t idx) const; // Tables, then stash, then old tables
+    size_t numSlots() const;
+    bool cuckooPath(Item &newItem, size_t hash1);
+    bool place(Item &item);
+    void drainStash();
     void rehash(size_t numBuckets);
-    void insert(const key_t& key, const value_t& value, bool updateValues);
+    void resize(size_t numBuckets);
+    void migrate(size_t numItems);
+    void insertItem(Item &newItem, bool updateValues); // The key must not be in the table
+    void eraseItem(Item *item); // Does nothing if item is nullptr
     void printToStream(std::ostream &os) const;
+    bool isMapped(const Item *table) const;
+    void freeTable(Item *&table); // Sets table to nullptr, unmaps the snapshot once no table uses it
+    static uint64_t hashCheck();
+    void countProbes(size_t lookups, size_t probes) const; // Does nothing without CUCKOO_HASH_STATISTICS
+    CuckooHashMap(void *mapping, size_t mappingSize); // Uses the tables of a validated snapshot in place
+
+    // Number of keys hashed and prefetched before any of them are probed
+    static constexpr size_t BATCH_SIZE = 16;
+
+    // Calls found(i, item) for each key, item is nullptr if keys[i] is not in the table
+    template <typename F>
+    void probeBatch(std::span<const key_t> keys, F found) const;
 
   public:
 
@@ -64,8 +182,11 @@ class CuckooHashMap
     // Constructors
     CuckooHashMap();
     CuckooHashMap(double epsilon, float downsizeThresh);
+    CuckooHashMap(double epsilon, float downsizeThresh, size_t maxPathDepth);
+    CuckooHashMap(double epsilon, float downsizeThresh, size_t maxPathDepth, size_t rehashStep);
     ~CuckooHashMap();
-    CuckooHashMap(const CuckooHashMap &other) = default;
+    CuckooHashMap(const CuckooHashMap &other); // Deep copy, also of tables mapped from a snapshot
+    CuckooHashMap &operator=(const CuckooHashMap &other) = delete;
 
     // Modification and Lookup;
     bool contains(const key_t &key) const;
@@ -74,6 +195,37 @@ class CuckooHashMap
     value_t &lookup(const key_t& key) const;
     void clear();
 
+    // Insertion without copies. Each returns true if the key was not in the map.
+    template <typename... Args>
+    bool emplace(Args&&... args); // Builds a value_type from args
+    template <typename K, typename... Args>
+    bool try_emplace(K&& key, Args&&... args); // Only builds the value if the key is not in the map
+    template <typename K, typename V>
+    bool insert_or_assign(K&& key, V&& value);
+
+    // Heterogeneous Lookup, e.g. std::string_view against std::string keys, with a transparent hash policy
+    template <typename K> requires TransparentHashPolicy<Hash, key_t, K>
+    bool contains(const K &key) const;
+    template <typename K> requires TransparentHashPolicy<Hash, key_t, K>
+    void erase(const K& key);
+    template <typename K> requires TransparentHashPolicy<Hash, key_t, K>
+    value_t &lookup(const K& key) const;
+
+    // Batched Lookup. Hides memory latency by prefetching the slots of many keys at once
+    void containsBatch(std::span<const key_t> keys, std::span<bool> found) const;
+    void lookupBatch(std::span<const key_t> keys, std::span<value_t*> values) const; // nullptr if not found
+
+    // Snapshots. open() maps the file instead of reading it, so only the pages a lookup touches are read.
+    // Changes to an opened map are never written back to the file.
+    void save(const std::string &path) const requires TRIVIAL_ITEMS;
+    static CuckooHashMap open(const std::string &path) requires TRIVIAL_ITEMS;
+
+#ifdef CUCKOO_HASH_STATISTICS
+    // Counters since construction or resetStats(), and the occupancy of each table. Scans the tables.
+    CuckooHashStats stats() const;
+    void resetStats();
+#endif
+
     // Data Lookup
     bool empty() const;
     size_t size() const;
@@ -90,10 +242,8 @@ class CuckooHashMap
         friend class CuckooHashMap;
 
   private: 
-        Item *t1_;
-        Item *t2_;
+        const CuckooHashMap *map_;
         size_t idx_;
-        size_t tableSize_; // numBuckets_
 
         /**
          * @brief Iterates over a table until a new idx is found. 
@@ -108,7 +258,7 @@ class CuckooHashMap
         using iterator_category = std::forward_iterator_tag;
 
         ConstIterator() = default;
-        ConstIterator(size_t idx, size_t tableSize, Item* table1, Item* table2);
+        ConstIterator(size_t idx, const CuckooHashMap *map);
         ConstIterator(const ConstIterator &other) = default;
         ConstIterator &operator=(const ConstIterator &other) = default;
         ~ConstIterator() = default;
@@ -122,32 +272,50 @@ class CuckooHashMap
     };
 };
 
-template<typename T>
+template<typename T, typename Hash = MixHashPolicy<T>>
 class CuckooHashSet
 {
+    static_assert(CuckooHashPolicy<Hash, T>, "Hash must provide hash1(key) and hash2(hash1)");
+
   private:
     class ConstIterator;
 
+    static constexpr size_t CACHE_LINE = 64;
+
+    // Slots are stored in groups that share one occupancy mask. As many keys
+    // as fit in a cache line after the mask go in a group, so a probe reads
+    // the mask and the key from the same line.
+    static constexpr size_t GROUP_SIZE = std::clamp<size_t>((CACHE_LINE - sizeof(uint64_t)) / sizeof(T), 1, 64);
+
+    struct alignas(sizeof(uint64_t) + GROUP_SIZE * sizeof(T) <= CACHE_LINE ? CACHE_LINE : alignof(uint64_t)) Group {
+        uint64_t valid_ = 0; // Bit i is set if keys_[i] is in the set
+        T keys_[GROUP_SIZE];
+    };
+
     // Data
-    std::vector<bool> valid1_;
-    std::vector<bool> valid2_;
     double epsilon_;
     size_t size_;
-    T* table1_;
-    T* table2_;
+    Group* table1_;
+    Group* table2_;
     size_t maxLoop_; // set to 3 log_1+e(n)
-    size_t numBuckets_;
-    std::hash<T> hash1_;
-    std::hash<std::string> hash2_;
+    size_t numBuckets_; // Slots per table, the last group of a table may be partly unused
+    Hash hash_;
     float downsizeThresh_;
 
     // Helper Functions
     size_t getHash1(const T& key) const;
     size_t getHash2(size_t hash1) const;
+    static size_t numGroups(size_t numBuckets);
+    static bool isValid(const Group *table, size_t idx);
+    static void setValid(Group *table, size_t idx, bool valid);
+    static T &keyAt(Group *table, size_t idx);
     void rehash(size_t numBuckets);
     void insert(const T& key, bool updateValues);
     void printToStream(std::ostream &os) const;
 
+    // Number of keys hashed and prefetched before any of them are probed
+    static constexpr size_t BATCH_SIZE = 16;
+
   public:
 
     // Type Names: 
@@ -168,6 +336,7 @@ class CuckooHashSet
 
     // Modification and Lookup
     bool contains(const T &key) const;
+    void containsBatch(std::span<const T> keys, std::span<bool> found) const;
     void insert(const T& key);
     void erase(const T& key);
     void clear();
@@ -184,12 +353,15 @@ class CuckooHashSet
         friend class CuckooHashSet;
 
     private:
-        const std::vector<bool>& v1_;
-        const std::vector<bool>& v2_;
-        size_t idx_;
-        T *t1_;
-        T *t2_;
+        size_t idx_; // Slot of table 1, then slot of table 2 minus numBuckets_
+        size_t tableSize_; // numBuckets_
+        Group *t1_;
+        Group *t2_;
 
+        /**
+         * @brief Moves to the next valid slot, skipping the empty slots of a
+         * group with one count trailing zeros of its mask.
+         */
         void iterateTable();
 
     public:
@@ -200,7 +372,7 @@ class CuckooHashSet
         using iterator_category = std::forward_iterator_tag;
 
         ConstIterator() = default;
-        ConstIterator(size_t idx, T* table1, T* table2, const std::vector<bool>& valid1, const std::vector<bool>& valid2);
+        ConstIterator(size_t idx, size_t tableSize, Group* table1, Group* table2);
         ConstIterator(const ConstIterator &other) = default;
         ConstIterator &operator=(const ConstIterator &other) = default;
         ~ConstIterator() = default;
@@ -213,11 +385,11 @@ class CuckooHashSet
     };
 };
 
-template<typename key_t,typename value_t>
-std::ostream &operator<<(std::ostream& os, const CuckooHashMap<key_t, value_t> &ch );
+template<typename key_t,typename value_t, typename Hash>
+std::ostream &operator<<(std::ostream& os, const CuckooHashMap<key_t, value_t, Hash> &ch );
 
-template<typename T>
-std::ostream &operator<<(std::ostream& os, const CuckooHashSet<T> &ch );
+template<typename T, typename Hash>
+std::ostream &operator<<(std::ostream& os, const CuckooHashSet<T, Hash> &ch );
 #include "cuckoo-hash-private.hpp"
 
 #endif // CUCKOO_HASH_HPP_INCLUDED
@@ -1,130 +1,216 @@
 #include "binomial.hpp"
+#include <bit>
+#include <stdexcept>
+#include <type_traits>
 
-template <typename T, typename P, typename Compare>
-BinomialHeap<T, P, Compare>::BinomialHeap():size_{0}, comp_{}, min_{nullptr}{}
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+BinomialHeap<T, P, Compare, Index>::BinomialHeap():roots_{nullptr}, rootsTail_{nullptr}, min_{nullptr}, size_{0}, comp_{}{}
 
-template <typename T, typename P, typename Compare>
-BinomialHeap<T, P, Compare>::~BinomialHeap()
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+BinomialHeap<T, P, Compare, Index>::~BinomialHeap()
 {
-    while (!nodes_.empty()) {
-        Node *n = nodes_.front();
-        delete n;
-        nodes_.pop_front();
+    // The pool frees the memory, only the items may need destructors
+    if constexpr (!std::is_trivially_destructible_v<Node>) {
+        forEachNode([this](Node *n){ pool_.destroy(n); });
     }
 }
 
-template <typename T, typename P, typename Compare>
-bool BinomialHeap<T, P, Compare>::empty() const{
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+bool BinomialHeap<T, P, Compare, Index>::empty() const{
     return size_ == 0;
 }
 
-template <typename T, typename P, typename Compare>
-size_t BinomialHeap<T, P, Compare>::size() const {
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+size_t BinomialHeap<T, P, Compare, Index>::size() const {
     return size_;
 }
 
-template <typename T, typename P, typename Compare>
-T BinomialHeap<T, P, Compare>::top() const{
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+T BinomialHeap<T, P, Compare, Index>::top() const{
     if (!size_){
         throw std::logic_error("Cannot get top of an empty heap");
     }
     return min_->item_.item_;
 }
 
-template <typename T, typename P, typename Compare>
-void BinomialHeap<T, P, Compare>::push(T item, P priority){
-    nodes_.push_front(new Node({item, priority}));
-    nodeMap_.insert({item, nodes_.front()});
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void BinomialHeap<T, P, Compare, Index>::push(T item, P priority){
+    Node *n = pool_.create(Item{item, priority});
+    n->sibling_ = roots_;
+    roots_ = n;
+    if (rootsTail_ == nullptr){
+        rootsTail_ = n;
+    }
+    nodeMap_[item] = n;
     if (min_ == nullptr or comp_(priority,min_->item_.priority_)) {
-        min_ = nodes_.front();
+        min_ = n;
     }
     ++size_;
 }
 
-template <typename T, typename P, typename Compare>
-void BinomialHeap<T, P, Compare>::pop(){
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+template <typename InputIt>
+void BinomialHeap<T, P, Compare, Index>::push_range(InputIt first, InputIt last){
+    // push only adds a root, so this is already O(n). The roots are merged by the next pop.
+    for (; first != last; ++first){
+        const auto &[item, priority] = *first;
+        push(item, priority);
+    }
+}
+
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void BinomialHeap<T, P, Compare, Index>::merge(BinomialHeap&& other){
+    if (&other == this){
+        return;
+    }
+    // Index the nodes of the smaller heap
+    if (size_ < other.size_){
+        pool_.swap(other.pool_);
+        std::swap(nodeMap_, other.nodeMap_);
+        std::swap(roots_, other.roots_);
+        std::swap(rootsTail_, other.rootsTail_);
+        std::swap(min_, other.min_);
+        std::swap(size_, other.size_);
+    }
+    if (!other.size_){
+        return;
+    }
+    other.forEachNode([this](Node *n){ nodeMap_[n->item_.item_] = n; });
+    other.nodeMap_.clear();
+    pool_.absorb(std::move(other.pool_));
+
+    if (roots_ == nullptr){
+        roots_ = other.roots_;
+    } else {
+        rootsTail_->sibling_ = other.roots_;
+    }
+    rootsTail_ = other.rootsTail_;
+    if (min_ == nullptr or comp_(other.min_->item_.priority_, min_->item_.priority_)){
+        min_ = other.min_;
+    }
+    size_ += other.size_;
+    other.roots_ = other.rootsTail_ = nullptr;
+    other.min_ = nullptr;
+    other.size_ = 0;
+}
+
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void BinomialHeap<T, P, Compare, Index>::pop(){
     if (!size_){
         throw std::logic_error("Cannot pop from an empty heap");
     }
 
-    // Step 1: From the minimum node: Iterate over the nodes and move them to the main list
-    for (Node* &n : min_->children_){
+    // Step 1: From the minimum node: Move the children to the main list
+    for (Node *n = min_->child_; n != nullptr; ){
+        Node *next = n->sibling_;
         n->parent_ = nullptr; // prevent dangling pointer. 
-        nodes_.push_back(n);
+        n->sibling_ = nullptr;
+        appendRoot(n);
+        n = next;
     }
-    // Step 2: Move the children to the main list
+    min_->child_ = nullptr;
+    // Step 2: Remove the minimum
     T item = min_->item_.item_;
     nodeMap_.erase(item);
-    min_->children_.clear();
     --size_;
     // Step 3: Cleanup
     cleanup();
 
 }
 
-template <typename T, typename P, typename Compare>
-BinomialHeap<T, P, Compare>::Node* BinomialHeap<T, P, Compare>::mergeNodes(Node* n1, Node* n2){
-    if (comp_(n1->item_.priority_, n2->item_.priority_)){
-        n2->parent_ = n1;
-        n1->children_.push_back(n2);
-        return n1;
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+template <typename F>
+void BinomialHeap<T, P, Compare, Index>::forEachNode(F f){
+    std::vector<Node *> stack;
+    if (roots_){
+        stack.push_back(roots_);
+    }
+    while (!stack.empty()) {
+        Node *n = stack.back();
+        stack.pop_back();
+        if (n->child_){
+            stack.push_back(n->child_);
+        }
+        if (n->sibling_){
+            stack.push_back(n->sibling_);
+        }
+        f(n);
+    }
+}
+
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void BinomialHeap<T, P, Compare, Index>::appendRoot(Node* n){
+    if (rootsTail_){
+        rootsTail_->sibling_ = n;
     } else {
-        n1->parent_ = n2;
-        n2->children_.push_back(n1);
-        return n2;
+        roots_ = n;
     }
+    rootsTail_ = n;
 }
 
-template <typename T, typename P, typename Compare>
-void BinomialHeap<T, P, Compare>::cleanup() {
-    short possibleRanks = std::ceil(std::log2(size_ + 1));
-    std::vector<Node *> nodeArray(possibleRanks);
-    std::ranges::fill(nodeArray, nullptr);
-    // Pop all nodes off node list and add them to the array and merge if necessary
-    while (!nodes_.empty()){
-        Node *n = nodes_.front();
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+BinomialHeap<T, P, Compare, Index>::Node* BinomialHeap<T, P, Compare, Index>::mergeNodes(Node* n1, Node* n2){
+    Node *winner = n2, *loser = n1;
+    if (comp_(n1->item_.priority_, n2->item_.priority_)){
+        std::swap(winner, loser);
+    }
+    loser->parent_ = winner;
+    loser->sibling_ = winner->child_;
+    winner->child_ = loser;
+    ++winner->rank_;
+    return winner;
+}
+
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void BinomialHeap<T, P, Compare, Index>::cleanup() {
+    // A tree of rank r holds exactly 2^r nodes
+    rankArray_.assign(std::bit_width(size_), nullptr);
+    // Take all nodes off the root list, add them to the array and merge if necessary
+    Node *n = roots_;
+    roots_ = rootsTail_ = nullptr;
+    while (n){
+        Node *next = n->sibling_;
+        n->sibling_ = nullptr;
         // If this is the min node, clean up its memory and move on
         if (n == min_){
-            delete min_;
+            pool_.destroy(min_);
             min_ = nullptr;
-            nodes_.pop_front();
+            n = next;
             continue;
         }
-        nodes_.pop_front();
         
         // Move the node and merge together
-        size_t rank = n->children_.size();
-        if (nodeArray[rank]){
-            while(nodeArray[rank]){
-                // Merge the nodes together
-                n = mergeNodes(n, nodeArray[rank]);
-                // At the END, they will be added to the list
-                nodeArray[rank] = nullptr;
-                ++rank;
-            }
-        } 
-        // After all the combining, add to the list at the appropriate index.
-        nodeArray[rank] = n;
+        size_t rank = n->rank_;
+        while(rankArray_[rank]){
+            // Merge the nodes together
+            n = mergeNodes(n, rankArray_[rank]);
+            // At the END, they will be added to the list
+            rankArray_[rank] = nullptr;
+            ++rank;
+        }
+        // After all the combining, add to the array at the appropriate index.
+        rankArray_[rank] = n;
+        n = next;
     }
 
-    // Re add to node list
-    for (Node *n : nodeArray) {
-        if (n){
+    // Re add to root list
+    for (Node *root : rankArray_) {
+        if (root){
             // If this is the new minimum, then keep track of it. 
-            nodes_.push_front(n);
-            if ((min_ == nullptr) or comp_(n->item_.priority_, min_->item_.priority_)){
-                min_ = n;
+            appendRoot(root);
+            if ((min_ == nullptr) or comp_(root->item_.priority_, min_->item_.priority_)){
+                min_ = root;
             }
         }
     }
 }
 
-template <typename T, typename P, typename Compare>
-void BinomialHeap<T, P, Compare>::changeKey(T item, P newPriority){
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void BinomialHeap<T, P, Compare, Index>::changeKey(T item, P newPriority){
     if (!nodeMap_.contains(item)){
         throw std::invalid_argument("Cannot change a key value for a key not in the heap");
     }
-    Node* n = nodeMap_.at(item);
+    Node* n = nodeMap_[item];
     P curPriority = n->item_.priority_;
     if (comp_(curPriority, newPriority)) {
         throw std::invalid_argument("Cannot change key priority to this value");
@@ -136,7 +222,8 @@ void BinomialHeap<T, P, Compare>::changeKey(T item, P newPriority){
         // just swap the values not the actual nodes.
         Node *parent = n->parent_;
         std::swap(parent->item_, n->item_);
-        std::swap(nodeMap_[parent->item_.item_], nodeMap_[n->item_.item_]);
+        nodeMap_[parent->item_.item_] = parent;
+        nodeMap_[n->item_.item_] = n;
         n = parent;
     }
     // Update minimum if necessary
@@ -145,12 +232,6 @@ void BinomialHeap<T, P, Compare>::changeKey(T item, P newPriority){
     }
 }
 
-template <typename T, typename P, typename Compare>
-BinomialHeap<T, P, Compare>::Node::Node(BinomialHeap<T, P, Compare>::Item item) : item_{item},parent_{nullptr}{}
-
-template <typename T, typename P, typename Compare>
-BinomialHeap<T, P, Compare>::Node::~Node(){
-    for (Node*& child : children_){
-        delete child;
-    }
-}
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+BinomialHeap<T, P, Compare, Index>::Node::Node(BinomialHeap<T, P, Compare, Index>::Item item) :
+    item_{item}, parent_{nullptr}, child_{nullptr}, sibling_{nullptr}, rank_{0}{}
@@ -2,12 +2,16 @@
 #define BINOMIAL_HEAP_HPP_INCLUDED
 
 #include <vector>
-#include <list>
-#include <map>
-#include <cmath>
+#include <unordered_map>
+#include <cstdint>
 #include <functional>
 
-template <typename T, typename P, typename Compare = std::less<P>>
+#include "node-pool.hpp"
+#include "dense-index.hpp"
+
+// Index maps each item to its node, e.g. std::unordered_map or DenseIndex
+template <typename T, typename P, typename Compare = std::less<P>,
+          template <typename, typename> class Index = std::unordered_map>
 class BinomialHeap
 {
 private:
@@ -17,27 +21,36 @@ private:
         T item_;
         P priority_;
     };
-    // Private Node struct to hold node data and pointers
+    // Private Node struct to hold node data and pointers. Children and roots
+    // are singly linked through sibling_, changeKey moves items rather than nodes.
     struct Node
     {
-        std::vector<Node *> children_;
         Item item_;
         Node *parent_;
+        Node *child_; // Most recently linked child
+        Node *sibling_;
+        uint8_t rank_; // Number of children
 
         Node(Item item_);
-        ~Node();
     };
 
     // Data
-    std::list<Node *> nodes_;
-    std::map<T, Node *> nodeMap_;
+    NodePool<Node> pool_;
+    Node *roots_; // Head of the root list
+    Node *rootsTail_;
+    Index<T, Node *> nodeMap_;
     Node *min_;
     size_t size_;
     Compare comp_;
+    std::vector<Node *> rankArray_; // Scratch space for cleanup(), kept to avoid reallocating on every pop
 
     // Private Methods
     void cleanup();
+    // Calls f on every node, f may destroy the node
+    template <typename F>
+    void forEachNode(F f);
     Node* mergeNodes(Node*n1, Node* n2);
+    void appendRoot(Node* n);
 
   public:
 
@@ -53,9 +66,23 @@ private:
     void pop();
     T top() const;
     void push(T item, P priority);
+    // Pushes (item, priority) pairs as roots, they are merged into trees by the next pop
+    template <typename InputIt>
+    void push_range(InputIt first, InputIt last);
     void changeKey(T item, P newPriority);
+
+    // Moves every item of other into this heap and leaves other empty. The
+    // root lists are spliced in O(1) and merged into trees by the next pop,
+    // plus indexing the nodes of the smaller heap in the larger one.
+    // The heaps must not share items.
+    void merge(BinomialHeap&& other);
 };
 
+// For items that are small non-negative integers, such as vertex ids. Finds
+// items through a flat array instead of hashing them.
+template <typename T, typename P, typename Compare = std::less<P>>
+using IndexedBinomialHeap = BinomialHeap<T, P, Compare, DenseIndex>;
+
 #include "binomial-private.hpp"
 
 #endif //BINOMIAL_HEAP_HPP_INCLUDED
\ No newline at end of file
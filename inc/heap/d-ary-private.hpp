@@ -1,31 +1,46 @@
 #include "d-ary.hpp"
 #include <algorithm>
 #include <stdexcept>
+#include <bit>
 
-template <typename T, typename priority_t, size_t D, typename Compare>
-DAryHeap<T, priority_t, D, Compare>::DAryHeap():size_{0}, comp_{}{}
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+DAryHeap<T, priority_t, D, Compare, Index>::DAryHeap():priorities_(PAD), size_{0}, comp_{}{}
 
-template <typename T, typename priority_t, size_t D, typename Compare>
-bool DAryHeap<T, priority_t, D, Compare>::empty() const{
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+template <typename InputIt>
+DAryHeap<T, priority_t, D, Compare, Index>::DAryHeap(InputIt first, InputIt last):DAryHeap(){
+    push_range(first, last);
+}
+
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+bool DAryHeap<T, priority_t, D, Compare, Index>::empty() const{
     return size_ == 0;
 }
 
-template <typename T, typename priority_t, size_t D, typename Compare>
-size_t DAryHeap<T, priority_t, D, Compare>::size() const{
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+size_t DAryHeap<T, priority_t, D, Compare, Index>::size() const{
     return size_;
 }
 
-template <typename T, typename priority_t, size_t D, typename Compare>
-const T& DAryHeap<T, priority_t, D, Compare>::top() const{
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+const T& DAryHeap<T, priority_t, D, Compare, Index>::top() const{
     if (size_ == 0){
         throw std::logic_error("Cannot get top of an empty heap");
     } else {
-        return elements_[0].item_;
+        return items_[0];
+    }
+}
+
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+const priority_t& DAryHeap<T, priority_t, D, Compare, Index>::topPriority() const{
+    if (size_ == 0){
+        throw std::logic_error("Cannot get top of an empty heap");
     }
+    return priority(0);
 }
 
-template <typename T, typename priority_t, size_t D, typename Compare>
-size_t DAryHeap<T, priority_t, D, Compare>::parent(size_t i) const{
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+size_t DAryHeap<T, priority_t, D, Compare, Index>::parent(size_t i) const{
     if (i > 0){
         return (i - 1) / D;
     } else {
@@ -33,90 +48,194 @@ size_t DAryHeap<T, priority_t, D, Compare>::parent(size_t i) const{
     }
 }
 
-template <typename T, typename priority_t, size_t D, typename Compare>
-size_t DAryHeap<T, priority_t, D, Compare>::leftmostChild(size_t i)const {
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+size_t DAryHeap<T, priority_t, D, Compare, Index>::leftmostChild(size_t i)const {
     return D * i + 1;
 }
 
-template <typename T, typename priority_t, size_t D, typename Compare>
-void DAryHeap<T, priority_t, D, Compare>::swap(size_t i1, size_t i2) {
-    std::swap(itemToIndex_[elements_[i1].item_], itemToIndex_[elements_[i2].item_]);
-    std::swap(elements_[i1], elements_[i2]);
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+void DAryHeap<T, priority_t, D, Compare, Index>::moveTo(size_t from, size_t to) {
+    items_[to] = std::move(items_[from]);
+    priority(to) = std::move(priority(from));
+    itemToIndex_[items_[to]] = to;
 }
 
-template <typename T, typename priority_t, size_t D, typename Compare>
-size_t DAryHeap<T, priority_t, D, Compare>::getMinChild(size_t i) const{
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+size_t DAryHeap<T, priority_t, D, Compare, Index>::getMinChild(size_t i) const{
     size_t lchild = leftmostChild(i);
     // function will not be called if size_ is zero
-    size_t end = std::min(size_, lchild + D);
-    auto compFunc = [this](const Item& i1, const Item& i2){return this->comp_(i1.priority_, i2.priority_);};
-    auto it = std::min_element(elements_.begin() + lchild, elements_.begin ()+ end, compFunc);
-    return (it - elements_.begin());
+    size_t count = std::min(D, size_ - lchild);
+    const priority_t *children = &priority(lchild);
+    if constexpr (SIMD_CHILDREN) {
+        if (count == D){
+            return lchild + simdMinChild(children);
+        }
+    }
+    size_t best = 0;
+    for (size_t c = 1; c < count; ++c){
+        if (comp_(children[c], children[best])){
+            best = c;
+        }
+    }
+    return lchild + best;
+}
+
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+size_t DAryHeap<T, priority_t, D, Compare, Index>::simdMinChild([[maybe_unused]] const priority_t *children) {
+#if defined(__SSE2__)
+    constexpr bool MIN = std::is_same_v<Compare, std::less<priority_t>>;
+    auto load = [children](size_t k){ return _mm_loadu_si128(reinterpret_cast<const __m128i*>(children + k)); };
+    // Picks the lane of a or b that comes first in the heap
+    auto first = [](__m128i a, __m128i b){
+        if constexpr (std::is_floating_point_v<priority_t>) {
+            __m128 x = _mm_castsi128_ps(a), y = _mm_castsi128_ps(b);
+            return _mm_castps_si128(MIN ? _mm_min_ps(x, y) : _mm_max_ps(x, y));
+        } else {
+            // SSE2 only compares signed lanes, flipping the sign bit orders unsigned ones
+            __m128i bias = _mm_set1_epi32(std::is_signed_v<priority_t> ? 0 : int(0x80000000u));
+            __m128i x = _mm_xor_si128(a, bias), y = _mm_xor_si128(b, bias);
+            __m128i takeB = MIN ? _mm_cmpgt_epi32(x, y) : _mm_cmpgt_epi32(y, x);
+            return _mm_or_si128(_mm_and_si128(takeB, b), _mm_andnot_si128(takeB, a));
+        }
+    };
+    __m128i best = load(0);
+    for (size_t k = 4; k < D; k += 4){
+        best = first(best, load(k));
+    }
+    // Spread the best priority to every lane
+    best = first(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(1, 0, 3, 2)));
+    best = first(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(2, 3, 0, 1)));
+    uint64_t matches = 0;
+    for (size_t k = 0; k < D; k += 4){
+        __m128i equal;
+        if constexpr (std::is_floating_point_v<priority_t>) {
+            equal = _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(load(k)), _mm_castsi128_ps(best)));
+        } else {
+            equal = _mm_cmpeq_epi32(load(k), best);
+        }
+        matches |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(equal))) << k;
+    }
+    return std::countr_zero(matches);
+#else
+    return 0;
+#endif
 }
 
-template <typename T, typename priority_t, size_t D, typename Compare>
-bool DAryHeap<T, priority_t, D, Compare>::isLeaf(size_t i) const{
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+bool DAryHeap<T, priority_t, D, Compare, Index>::isLeaf(size_t i) const{
     return leftmostChild(i) >= size_;
 }
 
-// Modification Functions
-template <typename T, typename priority_t, size_t D, typename Compare>
-void  DAryHeap<T, priority_t, D, Compare>::push(const T &item, priority_t key){
-    elements_.push_back(Item{item, key});
-    itemToIndex_[item] = size_;
-    size_t current_i = size_;
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+size_t DAryHeap<T, priority_t, D, Compare, Index>::siftUp(size_t i) {
+    T item = std::move(items_[i]);
+    priority_t key = std::move(priority(i));
 
     // While current isn't zero and current is less than its parent
-    while (current_i && comp_(elements_[current_i].priority_, elements_[parent(current_i)].priority_)){
-        size_t p = parent(current_i);
-        swap(current_i, p);
-        current_i = p;
+    while (i && comp_(key, priority(parent(i)))){
+        size_t p = parent(i);
+        moveTo(p, i);
+        i = p;
+    }
+    items_[i] = std::move(item);
+    priority(i) = std::move(key);
+    return i;
+}
+
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+size_t DAryHeap<T, priority_t, D, Compare, Index>::siftDown(size_t i) {
+    T item = std::move(items_[i]);
+    priority_t key = std::move(priority(i));
+
+    while (!isLeaf(i)){
+        size_t minChild = getMinChild(i);
+        if (!comp_(priority(minChild), key)){
+            break; // done
+        }
+        moveTo(minChild, i);
+        i = minChild;
+    }
+    items_[i] = std::move(item);
+    priority(i) = std::move(key);
+    return i;
+}
+
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+void DAryHeap<T, priority_t, D, Compare, Index>::heapify() {
+    if (size_ < 2){
+        return;
+    }
+    for (size_t i = parent(size_ - 1) + 1; i-- > 0;){
+        size_t cur = siftDown(i);
+        itemToIndex_[items_[cur]] = cur;
     }
+}
+
+// Modification Functions
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+void  DAryHeap<T, priority_t, D, Compare, Index>::push(const T &item, priority_t key){
+    // Throws before the heap changes if the index rejects the item
+    size_t &position = itemToIndex_[item];
+    items_.push_back(item);
+    priorities_.push_back(key);
     ++size_;
+    position = siftUp(size_ - 1);
+}
+
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+template <typename InputIt>
+void DAryHeap<T, priority_t, D, Compare, Index>::push_range(InputIt first, InputIt last){
+    size_t oldSize = size_;
+    for (; first != last; ++first){
+        const auto &[item, key] = *first;
+        itemToIndex_[item] = size_;
+        items_.push_back(item);
+        priorities_.push_back(key);
+        ++size_;
+    }
+    if (size_ - oldSize >= oldSize){
+        heapify();
+    } else {
+        for (size_t i = oldSize; i < size_; ++i){
+            size_t cur = siftUp(i);
+            itemToIndex_[items_[cur]] = cur;
+        }
+    }
 }
 
-template <typename T, typename priority_t, size_t D, typename Compare>
-void DAryHeap<T, priority_t, D, Compare>::pop(){
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+void DAryHeap<T, priority_t, D, Compare, Index>::pop(){
     if (!size_){
-        throw("Cannot pop from an empty heap");
+        throw std::logic_error("Cannot pop from an empty heap");
     }
-    
+
     // Move last element to "root"
-    swap(0, size_-1);
-    size_t cur = 0;
-    itemToIndex_.erase(elements_.back().item_);
-    elements_.pop_back();
+    itemToIndex_.erase(items_[0]);
     --size_;
-    while (!isLeaf(cur))
-    {
-        size_t minChild = getMinChild(cur);
-        if (comp_(elements_[cur].priority_, elements_[minChild].priority_)){
-            break; // done
-        } else {
-            swap(cur, minChild);
-            cur = minChild;
-        }
+    if (size_){
+        items_[0] = std::move(items_[size_]);
+        priority(0) = std::move(priority(size_));
+    }
+    items_.pop_back();
+    priorities_.pop_back();
+    if (size_){
+        size_t cur = siftDown(0);
+        itemToIndex_[items_[cur]] = cur;
     }
 }
 
-template <typename T, typename priority_t, size_t D, typename Compare>
-void DAryHeap<T, priority_t, D, Compare>::changeKey(T item, priority_t newKey){
+template <typename T, typename priority_t, size_t D, typename Compare, template <typename, typename> class Index>
+void DAryHeap<T, priority_t, D, Compare, Index>::changeKey(T item, priority_t newKey){
 
-    priority_t curPriority = elements_[itemToIndex_[item]].priority_;
-    if (comp_(curPriority,newKey)) {
-        throw std::invalid_argument("Cannot change key priority to this value");
-    }  else if (!itemToIndex_.contains(item)) {
+    // Check membership first, indexing a missing item would add it to the index
+    if (!itemToIndex_.contains(item)) {
         throw std::invalid_argument("Cannot change a key value for a key not in the heap");
     }
     // Update current index
-    size_t current_i = itemToIndex_[item];
-    elements_[current_i].priority_ = newKey;
-
-    // While current isn't zero and current is less than its parent
-    // std::less
-    while (current_i && comp_(elements_[current_i].priority_, elements_[parent(current_i)].priority_)){
-        size_t p = parent(current_i);
-        swap(current_i, p);
-        current_i = p;
+    size_t &position = itemToIndex_[item];
+    if (comp_(priority(position), newKey)) {
+        throw std::invalid_argument("Cannot change key priority to this value");
     }
+    priority(position) = newKey;
+    position = siftUp(position);
 }
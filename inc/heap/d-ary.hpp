@@ -4,39 +4,91 @@
 #include <vector>
 #include <unordered_map>
 #include <functional>
+#include <new>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "dense-index.hpp"
+#include "no-index.hpp"
 
 // Compare must be a binary predicate
-template <typename T, typename priority_t, size_t D=2, typename Compare = std::less<priority_t>>
+// Index maps each item to its position in the heap, e.g. std::unordered_map or DenseIndex
+template <typename T, typename priority_t, size_t D=2, typename Compare = std::less<priority_t>,
+          template <typename, typename> class Index = std::unordered_map>
 class DAryHeap {
-  
-    struct Item{
-      T item_;
-      priority_t priority_;
 
-      bool operator==(const Item &other) const { return (priority_ == other.priority_) && (item_ == other.item_); }
+    static constexpr size_t CACHE_LINE = 64;
+
+    // Allocates the priorities on a cache line boundary
+    template <typename U>
+    struct CacheAlignedAllocator {
+        using value_type = U;
+        template <typename V>
+        struct rebind { using other = CacheAlignedAllocator<V>; };
 
-      void swap(Item& left, Item& right){
-          std::swap(left.item_, right.item_);
-          std::swap(left.priority_, left.item_);
-      }
+        CacheAlignedAllocator() = default;
+        template <typename V>
+        CacheAlignedAllocator(const CacheAlignedAllocator<V>&){}
+
+        U *allocate(size_t n){ return static_cast<U*>(::operator new(n * sizeof(U), std::align_val_t(CACHE_LINE))); }
+        void deallocate(U *p, size_t){ ::operator delete(p, std::align_val_t(CACHE_LINE)); }
+        bool operator==(const CacheAlignedAllocator&) const { return true; }
     };
 
-    std::vector<Item> elements_;
-    std::unordered_map<T, size_t> itemToIndex_;
+    // Unused priorities in front of the root, so the children of every node
+    // start at a multiple of D. When D * sizeof(priority_t) divides 64 (e.g.
+    // D = 4 or 8 with 8 byte priorities) the children share one cache line.
+    static constexpr size_t PAD = std::is_default_constructible_v<priority_t> ? D - 1 : 0;
+
+#if defined(__SSE2__)
+    // getMinChild compares 4 children at a time for 4 byte priorities ordered by std::less or std::greater.
+    // Below 16 children the scalar loop is as fast.
+    static constexpr bool SIMD_CHILDREN = D % 4 == 0 and D >= 16 and D <= 64 and sizeof(priority_t) == 4 and
+                                          std::is_arithmetic_v<priority_t> and
+                                          (std::is_same_v<Compare, std::less<priority_t>> or
+                                           std::is_same_v<Compare, std::greater<priority_t>>);
+#else
+    static constexpr bool SIMD_CHILDREN = false;
+#endif
+
+    // Items and priorities are stored apart so finding the min child only reads priorities
+    std::vector<T> items_;
+    std::vector<priority_t, CacheAlignedAllocator<priority_t>> priorities_; // Node i is at i + PAD
+    Index<T, size_t> itemToIndex_;
     size_t size_;
     Compare comp_;
+
+    priority_t &priority(size_t i){ return priorities_[i + PAD]; }
+    const priority_t &priority(size_t i) const { return priorities_[i + PAD]; }
+
     // Gets the index of the parent node
     size_t parent(size_t i) const;
 
     // Gets the index of the leftmost child
     size_t leftmostChild(size_t i) const;
 
-    // Gets the index of the rightmost child. 
+    // Gets the index of the child with the smallest priority
     size_t getMinChild(size_t i) const;
 
+    // Offset of the smallest of D priorities, only used if SIMD_CHILDREN
+    static size_t simdMinChild(const priority_t *children);
+
     bool isLeaf(size_t i) const;
 
-    void swap(size_t i1, size_t i2);
+    // Move the node at i up or down to its place. Each node passed moves once
+    // into the hole, the moving node is written once at the end. Returns its
+    // new index, the caller updates the index of its item.
+    size_t siftUp(size_t i);
+    size_t siftDown(size_t i);
+
+    // Moves a node into the hole at to and updates the index of its item
+    void moveTo(size_t from, size_t to);
+
+    // Floyd's heap construction, sifts down every internal node starting from the last. O(size_)
+    void heapify();
 
   public:
 
@@ -44,6 +96,9 @@ class DAryHeap {
     using priority_type = priority_t;
 
     DAryHeap();
+    // Builds from (item, priority) pairs in O(n)
+    template <typename InputIt>
+    DAryHeap(InputIt first, InputIt last);
     ~DAryHeap() = default;
 
     bool empty() const;
@@ -52,7 +107,12 @@ class DAryHeap {
     void pop();
 
     void push(const T& item, priority_t key);
+    // Pushes (item, priority) pairs. Reheapifies in O(size()) when they at least double the heap
+    template <typename InputIt>
+    void push_range(InputIt first, InputIt last);
     const T& top() const;
+    // Priority of top()
+    const priority_t& topPriority() const;
 
     void changeKey(T item, priority_t newKey);
 
@@ -64,6 +124,16 @@ using BinaryMinHeap = DAryHeap<T, T, 2>;
 template <typename T>
 using BinaryHeap = DAryHeap<T, T, 2, std::greater<T>>;
 
+// For items that are small non-negative integers, such as vertex ids. Finds
+// items through a flat array instead of hashing them.
+template <typename T, typename priority_t, size_t D=2, typename Compare = std::less<priority_t>>
+using IndexedDAryHeap = DAryHeap<T, priority_t, D, Compare, DenseIndex>;
+
+// For heaps that never call changeKey. Pushes and pops do not update an
+// index, and the same item may be pushed more than once.
+template <typename T, typename priority_t, size_t D=2, typename Compare = std::less<priority_t>>
+using UnindexedDAryHeap = DAryHeap<T, priority_t, D, Compare, NoIndex>;
+
 #include "d-ary-private.hpp"
 
 #endif // DARY_HEAP_HPP_INCLUDED
@@ -0,0 +1,78 @@
+#ifndef DENSE_INDEX_HPP_INCLUDED
+#define DENSE_INDEX_HPP_INCLUDED
+
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * @brief Map from small non-negative integers (e.g. vertex ids) to positions,
+ * stored as one flat array indexed by the item. A drop in replacement for the
+ * std::unordered_map a heap uses to find its items: a lookup is one array
+ * access instead of hashing and following a bucket chain.
+ *
+ * Uses memory proportional to the largest item, not the number of items.
+ *
+ * @tparam T Integral item type
+ * @tparam V Position type, an integer index or a pointer
+ */
+template <typename T, typename V>
+class DenseIndex {
+    static_assert(std::is_integral_v<T>, "DenseIndex items must be integers");
+
+    std::vector<V> positions_;
+
+    // Marks items that are not in the index
+    static constexpr V absent(){
+        if constexpr (std::is_pointer_v<V>) {
+            return nullptr;
+        } else {
+            return V(-1);
+        }
+    }
+
+  public:
+    using key_type = T;
+    using mapped_type = V;
+
+    // Adds the item if it is not in the index
+    V &operator[](const T &item){
+        if constexpr (std::is_signed_v<T>) {
+            if (item < 0){
+                throw std::out_of_range("DenseIndex items must not be negative");
+            }
+        }
+        if (size_t(item) >= positions_.size()){
+            positions_.resize(size_t(item) + 1, absent());
+        }
+        return positions_[item];
+    }
+
+    bool contains(const T &item) const {
+        if constexpr (std::is_signed_v<T>) {
+            if (item < 0){
+                return false;
+            }
+        }
+        return size_t(item) < positions_.size() and positions_[item] != absent();
+    }
+
+    void erase(const T &item){
+        if (contains(item)){
+            positions_[item] = absent();
+        }
+    }
+
+    void clear(){
+        positions_.clear();
+    }
+
+    // Sizes the array for items up to maxItem, so pushes never reallocate it
+    void reserve(size_t maxItem){
+        if (maxItem >= positions_.size()){
+            positions_.resize(maxItem + 1, absent());
+        }
+    }
+};
+
+#endif // DENSE_INDEX_HPP_INCLUDED
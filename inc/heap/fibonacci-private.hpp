@@ -1,126 +1,219 @@
 #include "fibonacci.hpp"
-#include <iostream>
-template <typename T, typename P, typename Compare>
-FibonacciHeap<T, P, Compare>::FibonacciHeap():size_{0},min_{nullptr},comp_{}{}
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
 
-template <typename T, typename P, typename Compare>
-FibonacciHeap<T, P, Compare>::~FibonacciHeap() {
-    while (!nodes_.empty()) {
-        Node *n = nodes_.front();
-        delete n;
-        nodes_.pop_front();
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+FibonacciHeap<T, P, Compare, Index>::FibonacciHeap():comp_{},min_{nullptr},size_{0}{}
+
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+FibonacciHeap<T, P, Compare, Index>::~FibonacciHeap() {
+    // The pool frees the memory, only the items may need destructors
+    if constexpr (!std::is_trivially_destructible_v<Node>) {
+        forEachNode([this](Node *n){ pool_.destroy(n); });
     }
 }
 
-template <typename T, typename P, typename Compare>
-T FibonacciHeap<T, P, Compare>::top() const{
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+T FibonacciHeap<T, P, Compare, Index>::top() const{
     if (!size_){
         throw std::logic_error("Cannot get top of an empty heap");
     }
     return min_->item_.item_;
 }
 
-template <typename T, typename P, typename Compare>
-void FibonacciHeap<T, P, Compare>::push(T item, P priority){
-    nodes_.push_front(new Node({item, priority}));
-    nodeMap_.insert({item, nodes_.front()});
-    if (min_ == nullptr or comp_(priority, min_->item_.priority_)) {
-        min_ = nodes_.front();
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void FibonacciHeap<T, P, Compare, Index>::push(T item, P priority){
+    Node *n = pool_.create(Item{item, priority});
+    nodeMap_[item] = n;
+    if (min_ == nullptr) {
+        min_ = n;
+    } else {
+        splice(min_, n);
+        if (comp_(priority, min_->item_.priority_)) {
+            min_ = n;
+        }
     }
     ++size_;
 }
 
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+template <typename InputIt>
+void FibonacciHeap<T, P, Compare, Index>::push_range(InputIt first, InputIt last){
+    // push only adds a root, so this is already O(n). The roots are merged by the next pop.
+    for (; first != last; ++first){
+        const auto &[item, priority] = *first;
+        push(item, priority);
+    }
+}
+
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void FibonacciHeap<T, P, Compare, Index>::merge(FibonacciHeap&& other){
+    if (&other == this){
+        return;
+    }
+    // Index the nodes of the smaller heap
+    if (size_ < other.size_){
+        pool_.swap(other.pool_);
+        std::swap(nodeMap_, other.nodeMap_);
+        std::swap(min_, other.min_);
+        std::swap(size_, other.size_);
+    }
+    if (!other.size_){
+        return;
+    }
+    other.forEachNode([this](Node *n){ nodeMap_[n->item_.item_] = n; });
+    other.nodeMap_.clear();
+    pool_.absorb(std::move(other.pool_));
+
+    if (min_ == nullptr){
+        min_ = other.min_;
+    } else {
+        splice(min_, other.min_);
+        if (comp_(other.min_->item_.priority_, min_->item_.priority_)){
+            min_ = other.min_;
+        }
+    }
+    size_ += other.size_;
+    other.min_ = nullptr;
+    other.size_ = 0;
+}
 
 // Helper functions: 
-template <typename T, typename P, typename Compare>
-FibonacciHeap<T, P, Compare>::Node* FibonacciHeap<T, P, Compare>::mergeNodes(Node* n1, Node* n2){
-    // Clear the mark on the CHILD NODE
-    // May be possible to simplify this code. 
-    /*n1->item_.priority_ > n2->item_.priority_*/
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+template <typename F>
+void FibonacciHeap<T, P, Compare, Index>::forEachNode(F f){
+    std::vector<Node *> lists;
+    if (min_){
+        lists.push_back(min_);
+    }
+    while (!lists.empty()){
+        Node *first = lists.back();
+        lists.pop_back();
+        Node *n = first;
+        do {
+            Node *next = n->right_;
+            if (n->child_){
+                lists.push_back(n->child_);
+            }
+            f(n);
+            n = next;
+        } while (n != first);
+    }
+}
+
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void FibonacciHeap<T, P, Compare, Index>::remove(Node* n){
+    n->left_->right_ = n->right_;
+    n->right_->left_ = n->left_;
+    n->left_ = n;
+    n->right_ = n;
+}
+
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void FibonacciHeap<T, P, Compare, Index>::splice(Node* list, Node* n){
+    Node *listNext = list->right_;
+    Node *nLast = n->left_;
+    list->right_ = n;
+    n->left_ = list;
+    nLast->right_ = listNext;
+    listNext->left_ = nLast;
+}
+
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+FibonacciHeap<T, P, Compare, Index>::Node* FibonacciHeap<T, P, Compare, Index>::mergeNodes(Node* n1, Node* n2){
+    // n1 and n2 are roots on their own, the loser becomes a child of the winner
+    Node *winner = n1, *loser = n2;
     if (comp_(n2->item_.priority_, n1->item_.priority_)){
-        n1->parent_ = n2;
-        n2->children_.push_back(n1);
-        n1->index_ = n2->children_.size() -1;
-        n1->mark_ = false;
-        return n2;
+        std::swap(winner, loser);
+    }
+    loser->parent_ = winner;
+    loser->mark_ = false;
+    if (winner->child_){
+        splice(winner->child_, loser);
     } else {
-        n2->parent_ = n1;
-        n1->children_.push_back(n2);
-        n2->index_ = n1->children_.size() -1;
-        n2->mark_ = false;
-        return n1;
+        winner->child_ = loser;
     }
+    ++winner->rank_;
+    return winner;
 }
 
-template <typename T, typename P, typename Compare>
-void FibonacciHeap<T, P, Compare>::pop(){
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void FibonacciHeap<T, P, Compare, Index>::pop(){
     if (!size_){
         throw std::logic_error("Cannot pop from an empty heap");
     }
-    // Step 1: From the minimum node: Iterate over the nodes and move them to the main list
-    for (Node* &n : min_->children_){
-        n->parent_ = nullptr; // prevent dangling pointer. 
-        nodes_.push_back(n);
+    // Step 1: Move the children of the minimum to the root list
+    Node *z = min_;
+    if (z->child_){
+        Node *c = z->child_;
+        do {
+            c->parent_ = nullptr;
+            c = c->right_;
+        } while (c != z->child_);
+        splice(z, z->child_);
+        z->child_ = nullptr;
     }
-    // Step 2: Move the children to the main list
-    T item = min_->item_.item_;
-    nodeMap_.erase(item);
-    min_->children_.clear();
+    // Step 2: Remove the minimum
+    nodeMap_.erase(z->item_.item_);
     --size_;
-    // Step 3: Cleanup
-    cleanup();
+    if (z->right_ == z){
+        min_ = nullptr;
+    } else {
+        min_ = z->right_;
+        remove(z);
+        // Step 3: Cleanup
+        cleanup();
+    }
+    pool_.destroy(z);
 }
 
-template <typename T, typename P, typename Compare>
-void FibonacciHeap<T, P, Compare>::cleanup() {
-    short possibleRanks = std::ceil(std::log2(size_ + 1));
-    std::vector<Node *> nodeArray(possibleRanks + 1);
-    std::ranges::fill(nodeArray, nullptr);
-    // Pop all nodes off node list and add them to the array and merge if necessary
-    while (!nodes_.empty()){
-        Node *n = nodes_.front();
-        // If this is the min node, clean up its memory and move on
-        if (n == min_){
-            delete min_;
-            min_ = nullptr;
-            nodes_.pop_front();
-            continue;
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void FibonacciHeap<T, P, Compare, Index>::cleanup() {
+    roots_.clear();
+    Node *n = min_;
+    do {
+        roots_.push_back(n);
+        n = n->right_;
+    } while (n != min_);
+
+    // A tree of rank r holds at least phi^r nodes
+    size_t possibleRanks = size_t(std::log2(size_) * 1.4405) + 2;
+    rankArray_.assign(possibleRanks + 1, nullptr);
+    for (Node *root : roots_){
+        root->left_ = root->right_ = root;
+        size_t rank = root->rank_;
+        while (rankArray_[rank]){
+            // Merge the nodes together
+            root = mergeNodes(root, rankArray_[rank]);
+            rankArray_[rank] = nullptr;
+            ++rank;
         }
-        nodes_.pop_front();
-        
-        // Move the node and merge together
-        size_t rank = n->children_.size();
-        if (nodeArray[rank]){
-            while(nodeArray[rank]){
-                // Merge the nodes together
-                n = mergeNodes(n, nodeArray[rank]);
-                // At the END, they will be added to the list
-                nodeArray[rank] = nullptr;
-                ++rank;
-            }
-        } 
-        // After all the combining, add to the list at the appropriate index.
-        nodeArray[rank] = n;   
-    }
-
-    // Re add to node list
-    for (Node *n : nodeArray) {
-        if (n){
-            // If this is the new minimum, then keep track of it. 
-            nodes_.push_front(n);
-            if ((min_ == nullptr) or comp_(n->item_.priority_, min_->item_.priority_)){
-                min_ = n;
+        rankArray_[rank] = root;
+    }
+
+    // Rebuild the root list and find the new minimum
+    min_ = nullptr;
+    for (Node *root : rankArray_) {
+        if (root){
+            if (min_ == nullptr){
+                min_ = root;
+            } else {
+                splice(min_, root);
+                if (comp_(root->item_.priority_, min_->item_.priority_)){
+                    min_ = root;
+                }
             }
         }
     }
 }
 
-template <typename T, typename P, typename Compare>
-void FibonacciHeap<T, P, Compare>::changeKey(T item, P newPriority){
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void FibonacciHeap<T, P, Compare, Index>::changeKey(T item, P newPriority){
     if (!nodeMap_.contains(item)){
         throw std::invalid_argument("Cannot change a key value for a key not in the heap");
     }
-    Node* n = nodeMap_.at(item);
+    Node* n = nodeMap_[item];
     P curPriority = n->item_.priority_;
     if (comp_(curPriority, newPriority)) {
         throw std::invalid_argument("Cannot change key priority to this value");
@@ -140,49 +233,41 @@ void FibonacciHeap<T, P, Compare>::changeKey(T item, P newPriority){
     }
 }
 
-template <typename T, typename P, typename Compare>
-void FibonacciHeap<T, P, Compare>::cut(Node* c){
-    // Bookkeeping values
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void FibonacciHeap<T, P, Compare, Index>::cut(Node* c){
+    // Remove c from the child list of its parent
     Node* n = c->parent_;
-    uint8_t oldIndex = c->index_;
+    if (c->right_ == c){
+        n->child_ = nullptr;
+    } else {
+        if (n->child_ == c){
+            n->child_ = c->right_;
+        }
+        remove(c);
+    }
+    --n->rank_;
 
-    // Add to root list, set parent to nullptr, set index to 0
-    nodes_.push_back(c);
+    // Add to root list
     c->parent_ = nullptr;
-    c->index_ = 0;
     c->mark_ = false;
-
-    // Remove c from child list of n
-    if (oldIndex == n->children_.size()-1){
-        n->children_.pop_back();
-    } else {
-        n->children_[oldIndex] = n->children_.back();
-        n->children_.pop_back();
-        n->children_[oldIndex]->index_ = oldIndex;
-    }
+    splice(min_, c);
 }
 
-template <typename T, typename P, typename Compare>
-void FibonacciHeap<T, P, Compare>::cascadingCut(Node* c){
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+void FibonacciHeap<T, P, Compare, Index>::cascadingCut(Node* c){
     Node* p = c->parent_;
-    if (p){
+    while (p){
         if (!c->mark_){
             c->mark_ = true;
-        } else {
-            cut(c);
-            cascadingCut(p);
+            return;
         }
+        cut(c);
+        c = p;
+        p = c->parent_;
     }
 }
 
 // Node Functions: 
-template <typename T, typename P, typename Compare>
-FibonacciHeap<T, P, Compare>::Node::Node(FibonacciHeap<T, P, Compare>::Item item): 
-    item_{item}, parent_{nullptr}, index_{0}, mark_{false}{}
-
-template <typename T, typename P, typename Compare>
-FibonacciHeap<T, P, Compare>::Node::~Node(){
-    for (Node*& child : children_){
-        delete child;
-    }
-}
\ No newline at end of file
+template <typename T, typename P, typename Compare, template <typename, typename> class Index>
+FibonacciHeap<T, P, Compare, Index>::Node::Node(FibonacciHeap<T, P, Compare, Index>::Item item): 
+    item_{item}, parent_{nullptr}, child_{nullptr}, left_{this}, right_{this}, rank_{0}, mark_{false}{}
@@ -2,43 +2,60 @@
 #define FIBONACCI_HEAP_HPP_INCLUDED
 
 #include <vector>
-#include <list>
-#include <map>
+#include <unordered_map>
+#include <cstdint>
 #include <functional>
 
-template <typename T, typename P, typename Compare = std::less<P>>
+#include "node-pool.hpp"
+#include "dense-index.hpp"
+
+// Index maps each item to its node, e.g. std::unordered_map or DenseIndex
+template <typename T, typename P, typename Compare = std::less<P>,
+          template <typename, typename> class Index = std::unordered_map>
 class FibonacciHeap {
-  
+
     // Private struct to hold heap items
     struct Item {
         T item_;
         P priority_;
     };
 
-    struct Node {        
-        std::vector<Node*> children_;
+    // Siblings form a circular doubly linked list, so a node is cut from its
+    // parent in O(1). The roots are the siblings of min_.
+    struct Node {
         Item item_;
         Node *parent_;
-        uint8_t index_;
+        Node *child_; // Any one of the children
+        Node *left_;
+        Node *right_;
+        uint8_t rank_; // Number of children
         bool mark_;
 
         Node(Item item_);
-        ~Node();
     };
 
     // Data
-    std::list<Node *> nodes_;
-    std::map<T, Node *> nodeMap_;
+    NodePool<Node> pool_;
+    Index<T, Node *> nodeMap_;
     Compare comp_;
     Node *min_;
     size_t size_;
+    std::vector<Node *> roots_; // Scratch space for cleanup(), kept to avoid reallocating on every pop
+    std::vector<Node *> rankArray_;
 
     // Private Helper functions
     void cleanup();
+    // Calls f on every node, f may destroy the node
+    template <typename F>
+    void forEachNode(F f);
     Node* mergeNodes(Node* n1, Node* n2);
     void cut(Node* c);
     void cascadingCut(Node* c);
 
+    // Circular list helpers
+    static void remove(Node* n); // Unlinks n from its siblings
+    static void splice(Node* list, Node* n); // Adds n, with its siblings, next to list
+
     public:
 
     using value_type = T;
@@ -52,9 +69,23 @@ class FibonacciHeap {
     void pop();
     T top() const;
     void push(T item, P priority);
+    // Pushes (item, priority) pairs as roots, they are merged into trees by the next pop
+    template <typename InputIt>
+    void push_range(InputIt first, InputIt last);
     void changeKey(T item, P newPriority);
+
+    // Moves every item of other into this heap and leaves other empty. The
+    // root lists are spliced in O(1) and consolidated by the next pop, plus
+    // indexing the nodes of the smaller heap in the larger one.
+    // The heaps must not share items.
+    void merge(FibonacciHeap&& other);
 };
 
+// For items that are small non-negative integers, such as vertex ids. Finds
+// items through a flat array instead of hashing them.
+template <typename T, typename P, typename Compare = std::less<P>>
+using IndexedFibonacciHeap = FibonacciHeap<T, P, Compare, DenseIndex>;
+
 #include "fibonacci-private.hpp"
 
 #endif // FIBONACCI_HEAP_HPP_INCLUDED
@@ -0,0 +1,121 @@
+#include "multi-queue.hpp"
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+
+template <typename T, typename P, size_t D, typename Compare>
+MultiQueue<T, P, D, Compare>::MultiQueue(size_t threads, size_t c):size_{0},comp_{}{
+    if (threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (c == 0){
+        throw std::invalid_argument("A MultiQueue needs at least one shard per thread");
+    }
+    numShards_ = std::max<size_t>(2, c * threads);
+    shards_ = std::make_unique<Shard[]>(numShards_);
+}
+
+template <typename T, typename P, size_t D, typename Compare>
+void MultiQueue<T, P, D, Compare>::Shard::publish(){
+    if (!heap_.empty()){
+        top_.store(heap_.topPriority(), std::memory_order_relaxed);
+    }
+    empty_.store(heap_.empty(), std::memory_order_release);
+}
+
+template <typename T, typename P, size_t D, typename Compare>
+size_t MultiQueue<T, P, D, Compare>::randomShard(size_t numShards){
+    thread_local std::minstd_rand rng(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    return rng() % numShards;
+}
+
+template <typename T, typename P, size_t D, typename Compare>
+void MultiQueue<T, P, D, Compare>::push(const T& item, P priority){
+    // Moves on to another random shard rather than wait for a busy one
+    Shard *shard = &shards_[randomShard(numShards_)];
+    while (!shard->mutex_.try_lock()){
+        shard = &shards_[randomShard(numShards_)];
+    }
+    std::lock_guard lock(shard->mutex_, std::adopt_lock);
+    shard->heap_.push(item, priority);
+    shard->publish();
+    size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T, typename P, size_t D, typename Compare>
+MultiQueue<T, P, D, Compare>::Shard *MultiQueue<T, P, D, Compare>::better(Shard *a, Shard *b) const{
+    bool aEmpty = a->empty_.load(std::memory_order_acquire);
+    bool bEmpty = b->empty_.load(std::memory_order_acquire);
+    if (aEmpty or bEmpty){
+        return aEmpty ? (bEmpty ? nullptr : b) : a;
+    }
+    P aTop = a->top_.load(std::memory_order_relaxed);
+    P bTop = b->top_.load(std::memory_order_relaxed);
+    return comp_(bTop, aTop) ? b : a;
+}
+
+template <typename T, typename P, size_t D, typename Compare>
+std::pair<T, P> MultiQueue<T, P, D, Compare>::popLocked(Shard &shard){
+    std::pair<T, P> popped{shard.heap_.top(), shard.heap_.topPriority()};
+    shard.heap_.pop();
+    shard.publish();
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return popped;
+}
+
+template <typename T, typename P, size_t D, typename Compare>
+std::optional<std::pair<T, P>> MultiQueue<T, P, D, Compare>::tryPop(){
+    // Two random shards per attempt. Once that keeps finding empty or busy
+    // shards, the queue may be nearly empty, so look at every shard.
+    for (size_t attempt = 0; attempt < numShards_; ++attempt){
+        Shard *shard = better(&shards_[randomShard(numShards_)], &shards_[randomShard(numShards_)]);
+        if (shard == nullptr or !shard->mutex_.try_lock()){
+            continue;
+        }
+        std::lock_guard lock(shard->mutex_, std::adopt_lock);
+        if (!shard->heap_.empty()){
+            return popLocked(*shard);
+        }
+    }
+    for (size_t shard_i = 0; shard_i < numShards_; ++shard_i){
+        std::lock_guard lock(shards_[shard_i].mutex_);
+        if (!shards_[shard_i].heap_.empty()){
+            return popLocked(shards_[shard_i]);
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename T, typename P, size_t D, typename Compare>
+MultiQueue<T, P, D, Compare>::Shard *MultiQueue<T, P, D, Compare>::bestShard() const{
+    Shard *best = nullptr;
+    for (size_t shard_i = 0; shard_i < numShards_; ++shard_i){
+        Shard *shard = &shards_[shard_i];
+        std::lock_guard lock(shard->mutex_);
+        if (!shard->heap_.empty() and (best == nullptr or comp_(shard->heap_.topPriority(), best->heap_.topPriority()))){
+            best = shard;
+        }
+    }
+    return best;
+}
+
+template <typename T, typename P, size_t D, typename Compare>
+T MultiQueue<T, P, D, Compare>::top() const{
+    Shard *best = bestShard();
+    if (best == nullptr){
+        throw std::logic_error("Cannot get top of an empty heap");
+    }
+    std::lock_guard lock(best->mutex_);
+    return best->heap_.top();
+}
+
+template <typename T, typename P, size_t D, typename Compare>
+void MultiQueue<T, P, D, Compare>::pop(){
+    Shard *best = bestShard();
+    if (best == nullptr){
+        throw std::logic_error("Cannot pop from an empty heap");
+    }
+    std::lock_guard lock(best->mutex_);
+    popLocked(*best);
+}
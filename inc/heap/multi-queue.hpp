@@ -0,0 +1,80 @@
+#ifndef MULTI_QUEUE_HPP_INCLUDED
+#define MULTI_QUEUE_HPP_INCLUDED
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+#include "d-ary.hpp"
+
+// Concurrent relaxed priority queue, after Rihani, Sanders and Dementiev's
+// MultiQueue. It is made of c * threads shards, each an UnindexedDAryHeap
+// behind its own lock. push adds to a random shard. tryPop compares the tops
+// of two random shards and pops the better one, so it returns one of the
+// smallest items rather than always the smallest: on average within
+// O(c * threads) ranks of it.
+// push, tryPop, size and empty may be called by any number of threads at once.
+// top and pop are exact and lock every shard, for one thread at a time like
+// the other heaps.
+// There is no changeKey, and items may be pushed more than once.
+template <typename T, typename P, size_t D = 4, typename Compare = std::less<P>>
+class MultiQueue {
+    static_assert(std::is_trivially_copyable_v<P>, "Shard tops are published through std::atomic<P>");
+
+    // Aligned so threads working on neighbouring shards do not share cache lines
+    struct alignas(64) Shard {
+        std::mutex mutex_;
+        UnindexedDAryHeap<T, P, D, Compare> heap_;
+        // Copies of heap_.empty() and heap_.topPriority(), read without the lock
+        std::atomic<bool> empty_{true};
+        std::atomic<P> top_{};
+
+        // Updates empty_ and top_ after heap_ changed, mutex_ must be held
+        void publish();
+    };
+
+    // Data
+    std::unique_ptr<Shard[]> shards_;
+    size_t numShards_;
+    std::atomic<size_t> size_;
+    Compare comp_;
+
+    // Private Helper functions
+    static size_t randomShard(size_t numShards); // From a generator per thread
+    // Returns whichever of shards a and b has the better top, or nullptr if both look empty
+    Shard *better(Shard *a, Shard *b) const;
+    // Pops the top of a locked, non empty shard
+    std::pair<T, P> popLocked(Shard &shard);
+    // Shard whose top is the best of all, or nullptr if every shard is empty
+    Shard *bestShard() const;
+
+  public:
+
+    using value_type = T;
+    using priority_type = P;
+
+    // threads = 0 uses every hardware thread
+    explicit MultiQueue(size_t threads = 0, size_t c = 2);
+
+    bool empty() const {return size_.load(std::memory_order_relaxed) == 0;}
+    size_t size() const {return size_.load(std::memory_order_relaxed);}
+    size_t shards() const {return numShards_;}
+
+    void push(const T& item, P priority);
+    // Removes and returns one of the best items. Returns nothing only if
+    // every shard was empty when it looked.
+    std::optional<std::pair<T, P>> tryPop();
+
+    // Exact minimum, not safe against concurrent calls
+    T top() const;
+    void pop();
+};
+
+#include "multi-queue-private.hpp"
+
+#endif // MULTI_QUEUE_HPP_INCLUDED
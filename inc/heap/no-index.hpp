@@ -0,0 +1,27 @@
+#ifndef NO_INDEX_HPP_INCLUDED
+#define NO_INDEX_HPP_INCLUDED
+
+/**
+ * @brief Index for heaps that never call changeKey: remembers nothing, so
+ * pushes and pops skip the map updates entirely and items need not be
+ * unique. contains() is always false, so changeKey throws.
+ *
+ * @tparam T Item type
+ * @tparam V Position type
+ */
+template <typename T, typename V>
+class NoIndex {
+    V discarded_{}; // Where operator[] writes go
+
+  public:
+    using key_type = T;
+    using mapped_type = V;
+
+    V &operator[](const T &){ return discarded_; }
+    bool contains(const T &) const { return false; }
+    void erase(const T &){}
+    void clear(){}
+    void reserve(size_t){}
+};
+
+#endif // NO_INDEX_HPP_INCLUDED
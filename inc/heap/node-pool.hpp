@@ -0,0 +1,100 @@
+#ifndef NODE_POOL_HPP_INCLUDED
+#define NODE_POOL_HPP_INCLUDED
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+
+/**
+ * @brief Slab allocator for the nodes of one pointer based heap. Nodes are
+ * carved out of blocks that double in size, and destroyed nodes are kept on
+ * a free list for the next create(). A push costs no call to the global
+ * allocator once the heap has reached its size, and nodes pushed together
+ * sit next to each other in memory.
+ *
+ * Memory is returned when the pool is destroyed, not when nodes are.
+ *
+ * @tparam Node Node type
+ */
+template <typename Node>
+class NodePool {
+
+    static constexpr size_t FIRST_BLOCK = 64; // Nodes in the first block
+    static constexpr size_t MAX_BLOCK = 1 << 16; // Blocks stop growing at this many nodes
+
+    union Slot {
+        Slot *next_; // While on the free list
+        Node node_;  // While in use
+
+        Slot(){}
+        ~Slot(){}
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> blocks_;
+    Slot *free_ = nullptr; // Destroyed nodes
+    Slot *next_ = nullptr; // Unused part of the newest block
+    Slot *end_ = nullptr;
+    size_t blockSize_ = FIRST_BLOCK;
+
+  public:
+    NodePool() = default;
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+    NodePool(NodePool&& other) noexcept { swap(other); }
+    NodePool& operator=(NodePool&& other) noexcept { swap(other); return *this; }
+
+    template <typename... Args>
+    Node *create(Args&&... args){
+        Slot *slot;
+        if (free_){
+            slot = free_;
+            free_ = free_->next_;
+        } else {
+            if (next_ == end_){
+                blocks_.push_back(std::make_unique<Slot[]>(blockSize_));
+                next_ = blocks_.back().get();
+                end_ = next_ + blockSize_;
+                blockSize_ = std::min(2 * blockSize_, MAX_BLOCK);
+            }
+            slot = next_++;
+        }
+        return std::construct_at(&slot->node_, std::forward<Args>(args)...);
+    }
+
+    void destroy(Node *node){
+        std::destroy_at(node);
+        Slot *slot = reinterpret_cast<Slot*>(node);
+        slot->next_ = free_;
+        free_ = slot;
+    }
+
+    // Takes over the memory of other, its nodes stay valid and now belong to this pool.
+    // The unused part of other's newest block is not reused.
+    void absorb(NodePool&& other){
+        if (&other == this){
+            return;
+        }
+        for (std::unique_ptr<Slot[]> &block : other.blocks_){
+            blocks_.push_back(std::move(block));
+        }
+        while (other.free_){
+            Slot *slot = other.free_;
+            other.free_ = slot->next_;
+            slot->next_ = free_;
+            free_ = slot;
+        }
+        other.blocks_.clear();
+        other.next_ = other.end_ = nullptr;
+    }
+
+    void swap(NodePool& other) noexcept {
+        std::swap(blocks_, other.blocks_);
+        std::swap(free_, other.free_);
+        std::swap(next_, other.next_);
+        std::swap(end_, other.end_);
+        std::swap(blockSize_, other.blockSize_);
+    }
+};
+
+#endif // NODE_POOL_HPP_INCLUDED
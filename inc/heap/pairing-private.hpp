@@ -1,6 +1,8 @@
 
 #include "pairing.hpp"
 #include <iostream>
+#include <ranges>
+#include <type_traits>
 
 template <typename T, typename P, typename Compare>
 PairingHeap<T, P, Compare>::PairingHeap():size_{0},root_{nullptr},comp_{}{}
@@ -13,10 +15,10 @@ PairingHeap<T, P, Compare>::~PairingHeap(){
 template <typename T, typename P, typename Compare>
 void PairingHeap<T, P, Compare>::push(T item, P priority){
     if (!root_) {
-        root_ = new Node(Item{item, priority});
+        root_ = pool_.create(Item{item, priority});
         nodeMap_.insert({item, root_});
     } else {
-        Node* n = new Node(Item{item, priority});
+        Node* n = pool_.create(Item{item, priority});
         nodeMap_.insert({item, n});
         root_ = link(root_,n);
     }
@@ -24,6 +26,38 @@ void PairingHeap<T, P, Compare>::push(T item, P priority){
     
 }
 
+template <typename T, typename P, typename Compare>
+template <typename InputIt>
+void PairingHeap<T, P, Compare>::push_range(InputIt first, InputIt last){
+    // Linking each node to the root is one comparison per item, less work
+    // than linking in rounds. The next pop pairs up the root's children.
+    if constexpr (std::forward_iterator<InputIt>){
+        nodeMap_.reserve(nodeMap_.size() + std::distance(first, last));
+    }
+    for (; first != last; ++first){
+        const auto &[item, priority] = *first;
+        push(item, priority);
+    }
+}
+
+template <typename T, typename P, typename Compare>
+void PairingHeap<T, P, Compare>::merge(PairingHeap&& other){
+    if (&other == this or !other.root_){
+        return;
+    }
+    if (nodeMap_.size() < other.nodeMap_.size()){
+        nodeMap_.swap(other.nodeMap_);
+    }
+    nodeMap_.merge(other.nodeMap_);
+    other.nodeMap_.clear();
+    pool_.absorb(std::move(other.pool_));
+
+    root_ = root_ ? link(root_, other.root_) : other.root_;
+    size_ += other.size_;
+    other.root_ = nullptr;
+    other.size_ = 0;
+}
+
 // Delete Min
 template <typename T, typename P, typename Compare>
 void PairingHeap<T, P, Compare>::pop(){
@@ -33,13 +67,14 @@ void PairingHeap<T, P, Compare>::pop(){
     } 
     if (size_ == 1){
         nodeMap_.erase(root_->item_.item_);
-        delete root_;
+        pool_.destroy(root_);
         root_ = nullptr;
         --size_;
         return;
     }
     // Get the nodes that are the direct child of the minimum
-    std::vector<Node*> nodes;
+    std::vector<Node*> &nodes = children_;
+    nodes.clear();
     Node* curNode = root_->lchild_;
     while (curNode)
     {
@@ -49,7 +84,8 @@ void PairingHeap<T, P, Compare>::pop(){
         nodes.back()->sibling_ = nullptr; 
     }
     // Pair the nodes up
-    std::vector<Node*> paired;
+    std::vector<Node*> &paired = paired_;
+    paired.clear();
     for (size_t node_i = 0; node_i < nodes.size(); node_i+= 2){
         // Last node edge case
         if (node_i == nodes.size() - 1){
@@ -61,14 +97,13 @@ void PairingHeap<T, P, Compare>::pop(){
 
     // Cleanup memory and replace root
     nodeMap_.erase(root_->item_.item_);
-    delete root_;
+    pool_.destroy(root_);
     root_ = paired.back();
     paired.pop_back();
     root_->parent_ = nullptr;
 
-    // Reverse list and pair them together
-    std::ranges::reverse(paired);
-    for (Node* n : paired){
+    // Link them together from the back
+    for (Node* n : std::ranges::reverse_view(paired)){
         n->sibling_ = nullptr; // The trees are "separated" so their sibling is undefined.
         n->parent_ = nullptr; // The parent in the binary tree is also undefined. 
         root_ = link(n, root_);
@@ -159,10 +194,22 @@ PairingHeap<T, P, Compare>::Node::Node(Item item):
 
 template <typename T, typename P, typename Compare>
 void PairingHeap<T, P, Compare>::destructorHelper(Node*& node){
+    // The pool frees the memory, only the items may need destructors
+    if constexpr (std::is_trivially_destructible_v<Node>){
+        node = nullptr;
+        return;
+    }
+    // Iterative, sibling lists can be as long as the heap
+    std::vector<Node*> stack;
     if (node != nullptr){
-        destructorHelper(node->lchild_);
-        destructorHelper(node->sibling_);
-        delete node;        
+        stack.push_back(node);
     }
-    
+    while (!stack.empty()){
+        Node* n = stack.back();
+        stack.pop_back();
+        if (n->lchild_) stack.push_back(n->lchild_);
+        if (n->sibling_) stack.push_back(n->sibling_);
+        pool_.destroy(n);
+    }
+    node = nullptr;
 }
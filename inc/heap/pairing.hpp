@@ -6,6 +6,9 @@
 #include <unordered_map>
 #include <vector>
 #include <algorithm>
+#include <iterator>
+
+#include "node-pool.hpp"
 
 template <typename T, typename P, typename Compare = std::less<T>>
 class PairingHeap {
@@ -28,10 +31,13 @@ class PairingHeap {
     };
     
     // Data
+    NodePool<Node> pool_;
     std::unordered_map<T, Node *> nodeMap_;
     Compare comp_;
     Node *root_; // also the min!
     size_t size_;
+    std::vector<Node*> children_; // Scratch space for pop(), kept to avoid reallocating on every pop
+    std::vector<Node*> paired_;
 
     // Helper Functions
     void destructorHelper(Node*& node);
@@ -52,7 +58,15 @@ class PairingHeap {
     void pop();
     T top() const;
     void push(T item, P priority);
+    // Pushes (item, priority) pairs, each linked to the root like push
+    template <typename InputIt>
+    void push_range(InputIt first, InputIt last);
     void changeKey(T item, P newPriority);
+
+    // Moves every item of other into this heap and leaves other empty. One
+    // link, O(1), plus moving the smaller item map into the larger one.
+    // The heaps must not share items.
+    void merge(PairingHeap&& other);
 };
 
 #include "pairing-private.hpp"
@@ -0,0 +1,121 @@
+#include "radix.hpp"
+#include <bit>
+#include <stdexcept>
+
+template <typename T, std::unsigned_integral P, template <typename, typename> class Index>
+RadixHeap<T, P, Index>::RadixHeap():last_{0},size_{0}{}
+
+template <typename T, std::unsigned_integral P, template <typename, typename> class Index>
+size_t RadixHeap<T, P, Index>::bucketOf(P priority, P last){
+    return std::bit_width(P(priority ^ last));
+}
+
+template <typename T, std::unsigned_integral P, template <typename, typename> class Index>
+void RadixHeap<T, P, Index>::checkMonotone(P priority) const{
+    if (priority < last_){
+        throw std::invalid_argument("Priority is smaller than the last popped priority");
+    }
+}
+
+template <typename T, std::unsigned_integral P, template <typename, typename> class Index>
+void RadixHeap<T, P, Index>::add(Item item){
+    size_t bucket = bucketOf(item.priority_, last_);
+    itemToSlot_[item.item_] = buckets_[bucket].size() << BUCKET_BITS | bucket;
+    buckets_[bucket].push_back(item);
+}
+
+template <typename T, std::unsigned_integral P, template <typename, typename> class Index>
+void RadixHeap<T, P, Index>::remove(size_t slot){
+    // Fill the hole with the last item of the bucket
+    std::vector<Item> &bucket = buckets_[slot & ((1 << BUCKET_BITS) - 1)];
+    size_t offset = slot >> BUCKET_BITS;
+    if (offset + 1 != bucket.size()){
+        bucket[offset] = bucket.back();
+        itemToSlot_[bucket[offset].item_] = slot;
+    }
+    bucket.pop_back();
+}
+
+template <typename T, std::unsigned_integral P, template <typename, typename> class Index>
+void RadixHeap<T, P, Index>::redistribute(){
+    size_t i = 1;
+    while (buckets_[i].empty()){
+        ++i;
+    }
+    P min = buckets_[i].front().priority_;
+    for (const Item &item : buckets_[i]){
+        if (item.priority_ < min){
+            min = item.priority_;
+        }
+    }
+    last_ = min;
+    // Every item differs from min below bit i - 1, so it lands in a lower bucket
+    scratch_.swap(buckets_[i]);
+    for (const Item &item : scratch_){
+        add(item);
+    }
+    scratch_.clear();
+}
+
+template <typename T, std::unsigned_integral P, template <typename, typename> class Index>
+T RadixHeap<T, P, Index>::top() const{
+    if (!size_){
+        throw std::logic_error("Cannot get top of an empty heap");
+    }
+    if (!buckets_[0].empty()){
+        return buckets_[0].back().item_;
+    }
+    // The item pop() will return: the last minimum of the first non empty
+    // bucket, it ends up at the back of bucket 0 after redistribute()
+    size_t i = 1;
+    while (buckets_[i].empty()){
+        ++i;
+    }
+    const Item *min = &buckets_[i].front();
+    for (const Item &item : buckets_[i]){
+        if (item.priority_ <= min->priority_){
+            min = &item;
+        }
+    }
+    return min->item_;
+}
+
+template <typename T, std::unsigned_integral P, template <typename, typename> class Index>
+void RadixHeap<T, P, Index>::pop(){
+    if (!size_){
+        throw std::logic_error("Cannot pop from an empty heap");
+    }
+    if (buckets_[0].empty()){
+        redistribute();
+    }
+    itemToSlot_.erase(buckets_[0].back().item_);
+    buckets_[0].pop_back();
+    --size_;
+}
+
+template <typename T, std::unsigned_integral P, template <typename, typename> class Index>
+void RadixHeap<T, P, Index>::push(T item, P priority){
+    checkMonotone(priority);
+    add(Item{item, priority});
+    ++size_;
+}
+
+template <typename T, std::unsigned_integral P, template <typename, typename> class Index>
+void RadixHeap<T, P, Index>::changeKey(T item, P newPriority){
+    if (!itemToSlot_.contains(item)){
+        throw std::invalid_argument("Cannot change a key value for a key not in the heap");
+    }
+    size_t slot = itemToSlot_[item];
+    size_t bucket = slot & ((1 << BUCKET_BITS) - 1);
+    Item &cur = buckets_[bucket][slot >> BUCKET_BITS];
+    if (cur.priority_ < newPriority){
+        throw std::invalid_argument("Cannot change key priority to this value");
+    }
+    checkMonotone(newPriority);
+    if (bucketOf(newPriority, last_) == bucket){
+        cur.priority_ = newPriority;
+    } else {
+        remove(slot);
+        add(Item{item, newPriority});
+    }
+}
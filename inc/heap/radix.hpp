@@ -0,0 +1,68 @@
+#ifndef RADIX_HEAP_HPP_INCLUDED
+#define RADIX_HEAP_HPP_INCLUDED
+
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <concepts>
+#include <limits>
+
+#include "dense-index.hpp"
+
+// Monotone min heap for unsigned integer priorities, such as distances in
+// Dijkstra with integer weights. Every push and changeKey must use a priority
+// no smaller than the last popped one.
+// Bucket i holds the priorities whose highest bit differing from the last
+// popped priority is bit i - 1, so an item moves down at most once per bit
+// before it is popped and no priorities are compared on push or changeKey.
+// Index maps each item to its slot, e.g. std::unordered_map or DenseIndex
+template <typename T, std::unsigned_integral P,
+          template <typename, typename> class Index = std::unordered_map>
+class RadixHeap {
+
+    struct Item {
+        T item_;
+        P priority_;
+    };
+
+    static constexpr size_t BUCKETS = std::numeric_limits<P>::digits + 1;
+    static constexpr size_t BUCKET_BITS = 7; // Enough for BUCKETS <= 128
+
+    // Data
+    std::array<std::vector<Item>, BUCKETS> buckets_;
+    Index<T, size_t> itemToSlot_; // offset in the bucket << BUCKET_BITS | bucket
+    std::vector<Item> scratch_; // Holds the bucket being redistributed, kept to reuse its memory
+    P last_; // Last popped priority
+    size_t size_;
+
+    // Private Helper functions
+    static size_t bucketOf(P priority, P last);
+    void add(Item item);
+    void remove(size_t slot);
+    // Moves the items of the first non empty bucket down, so bucket 0 holds the minimum
+    void redistribute();
+    void checkMonotone(P priority) const;
+
+  public:
+
+    using value_type = T;
+    using priority_type = P;
+
+    RadixHeap();
+
+    bool empty() const {return size_ == 0;}
+    size_t size() const {return size_;}
+    void pop();
+    T top() const;
+    void push(T item, P priority);
+    void changeKey(T item, P newPriority);
+};
+
+// For items that are small non-negative integers, such as vertex ids. Finds
+// items through a flat array instead of hashing them.
+template <typename T, std::unsigned_integral P>
+using IndexedRadixHeap = RadixHeap<T, P, DenseIndex>;
+
+#include "radix-private.hpp"
+
+#endif // RADIX_HEAP_HPP_INCLUDED
@@ -3,6 +3,7 @@
 #include <concepts>
 #include <cstddef>
 #include <vector>
+#include <utility>
 
 // Interface for a Tree Map structure
 template <typename TreeType>
@@ -48,6 +49,20 @@ concept BasicHeap = requires(T &heap,
     heap.top();
 };
 
+// Heap that can also add many (item, priority) pairs at once, faster than
+// pushing them one by one. Optional, not part of Heap or BasicHeap.
+template <typename T>
+concept BulkHeap = BasicHeap<T> && requires(T &heap,
+                        std::vector<std::pair<typename T::value_type, typename T::priority_type>>::iterator it) {
+    heap.push_range(it, it);
+};
+
+// Heap that can absorb another heap of the same type without popping it
+template <typename T>
+concept MeldableHeap = Heap<T> && requires(T &heap, T &&other) {
+    heap.merge(std::move(other));
+};
+
 // Double Ended Queue: 
 template <typename Container>
 concept Queue = requires(Container &container, const typename Container::value_type &value) {
@@ -0,0 +1,33 @@
+#include <numeric>
+// Built with CUCKOO_HASH_STATISTICS defined, see tests/CMakeLists.txt. The
+// other cuckoo tests are built without it.
+#include "cuckoo-hash/cuckoo-hash.hpp"
+#include "gtest/gtest.h"
+
+TEST(CuckooStatsTest, cuckooMapStatistics){
+    CuckooHashMap<int, int> ch;
+    for (int i = 0; i < 1000; ++i){
+        ch.insert(i, i);
+    }
+    CuckooHashStats stats = ch.stats();
+    EXPECT_GT(stats.rehashes_, 0);
+    EXPECT_GE(stats.maxRehashSeconds_, 0);
+    EXPECT_LE(stats.maxRehashSeconds_, stats.rehashSeconds_);
+    // Rehashing places every item again
+    size_t placed = std::accumulate(stats.evictionChains_.begin(), stats.evictionChains_.end(), stats.stashed_);
+    EXPECT_GE(placed, 1000);
+    EXPECT_EQ(stats.lookups_, 1000); // Each insert checks for the key first
+    EXPECT_EQ(stats.table1Items_ + stats.table2Items_ + stats.stashItems_ + stats.oldTableItems_, 1000);
+
+    ch.resetStats();
+    EXPECT_EQ(ch.stats().lookups_, 0);
+    EXPECT_TRUE(ch.stats().evictionChains_.empty());
+    for (int i = 0; i < 2000; ++i){
+        ch.contains(i);
+    }
+    stats = ch.stats();
+    EXPECT_EQ(stats.lookups_, 2000);
+    EXPECT_GE(stats.averageProbes(), 1.0);
+    EXPECT_LE(stats.averageProbes(), 2.0 + stats.stashItems_);
+    EXPECT_EQ(stats.rehashes_, 0);
+}
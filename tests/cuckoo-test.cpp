@@ -1,8 +1,20 @@
 #include <iostream>
 #include <string>
+#include <numeric>
 #include "cuckoo-hash/cuckoo-hash.hpp"
+#include "cuckoo-hash/bucket-cuckoo-hash.hpp"
+#include "cuckoo-hash/concurrent-cuckoo-hash.hpp"
+#include "cuckoo-hash/cuckoo-filter.hpp"
 #include <cassert>
 #include <array>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
 #include "gtest/gtest.h"
 
 using namespace std;
@@ -36,6 +48,235 @@ TEST_F(CuckooTest, cuckooMap){
     EXPECT_EQ(ch["string"], 144);
 }
 
+TEST_F(CuckooTest, cuckooMapPathSearch){
+    // Short paths send many inserts to the stash, so most keys are found there
+    // at some point before a rehash
+    for (size_t depth : {1, 2, 0}){
+        CuckooHashMap<int, int> ch(0.3, 0.2, depth);
+        for (int i = 0; i < 5000; ++i){
+            ch.insert(i, 2 * i);
+        }
+        EXPECT_EQ(ch.size(), 5000);
+        for (int i = 0; i < 5000; ++i){
+            ASSERT_TRUE(ch.contains(i));
+            EXPECT_EQ(ch.lookup(i), 2 * i);
+        }
+        EXPECT_FALSE(ch.contains(5000));
+
+        size_t count = 0;
+        for (auto [key, value] : ch){
+            EXPECT_EQ(value, 2 * key);
+            ++count;
+        }
+        EXPECT_EQ(count, ch.size());
+
+        for (int i = 0; i < 5000; i += 2){
+            ch.erase(i);
+        }
+        EXPECT_EQ(ch.size(), 2500);
+        for (int i = 0; i < 5000; ++i){
+            EXPECT_EQ(ch.contains(i), i % 2 == 1);
+        }
+    }
+}
+
+TEST_F(CuckooTest, cuckooMapIncrementalRehash){
+    // Every key must stay visible while items move between the old and new tables
+    CuckooHashMap<int, int> ch(0.4, 0.2, 0, 4);
+    for (int i = 0; i < 20000; ++i){
+        ch.insert(i, -i);
+        if (i % 1000 == 999){
+            for (int j = 0; j <= i; ++j){
+                ASSERT_TRUE(ch.contains(j));
+                EXPECT_EQ(ch.lookup(j), -j);
+            }
+            size_t count = 0;
+            for (auto [key, value] : ch){
+                EXPECT_EQ(value, -key);
+                ++count;
+            }
+            EXPECT_EQ(count, ch.size());
+        }
+    }
+    EXPECT_EQ(ch.size(), 20000);
+
+    // Shrinks one step at a time too
+    for (int i = 0; i < 19900; ++i){
+        ch.erase(i);
+        if (i % 1000 == 999){
+            for (int j = 0; j < 20000; ++j){
+                ASSERT_EQ(ch.contains(j), j > i);
+            }
+        }
+    }
+    EXPECT_EQ(ch.size(), 100);
+    EXPECT_GT(ch.loadFactor(), 0.1);
+    for (int i = 19900; i < 20000; ++i){
+        EXPECT_EQ(ch.lookup(i), -i);
+    }
+}
+
+// Counts copies, so tests can check that evictions and rehashes only move
+struct CopyCounter {
+    static inline size_t copies_ = 0;
+    int value_;
+
+    CopyCounter(int value = 0): value_{value} {}
+    CopyCounter(const CopyCounter &other): value_{other.value_} { ++copies_; }
+    CopyCounter(CopyCounter &&other) = default;
+    CopyCounter &operator=(const CopyCounter &other){ value_ = other.value_; ++copies_; return *this; }
+    CopyCounter &operator=(CopyCounter &&other) = default;
+};
+
+TEST_F(CuckooTest, cuckooMapEmplace){
+    CuckooHashMap<int, CopyCounter> ch;
+    CopyCounter::copies_ = 0;
+    for (int i = 0; i < 10000; ++i){
+        EXPECT_TRUE(ch.try_emplace(i, i));
+    }
+    for (int i = 0; i < 10000; i += 2){
+        ch.erase(i);
+    }
+    EXPECT_EQ(CopyCounter::copies_, 0);
+    EXPECT_EQ(ch.size(), 5000);
+
+    EXPECT_FALSE(ch.try_emplace(1, -1));
+    EXPECT_EQ(ch.lookup(1).value_, 1);
+    EXPECT_FALSE(ch.insert_or_assign(1, CopyCounter(-1)));
+    EXPECT_EQ(ch.lookup(1).value_, -1);
+    EXPECT_TRUE(ch.insert_or_assign(0, CopyCounter(7)));
+    EXPECT_EQ(ch.lookup(0).value_, 7);
+    EXPECT_TRUE(ch.emplace(std::pair<int, int>{2, 9}));
+    EXPECT_EQ(ch.lookup(2).value_, 9);
+    EXPECT_EQ(CopyCounter::copies_, 0);
+
+    // Values that can only be moved
+    CuckooHashMap<int, std::unique_ptr<int>> owners;
+    for (int i = 0; i < 1000; ++i){
+        owners.try_emplace(i, std::make_unique<int>(i));
+    }
+    for (int i = 0; i < 1000; ++i){
+        ASSERT_TRUE(owners.contains(i));
+        EXPECT_EQ(*owners.lookup(i), i);
+    }
+}
+
+TEST_F(CuckooTest, cuckooMapHeterogeneousLookup){
+    CuckooHashMap<string, int> ch;
+    for (size_t i = 0; i < 30; ++i){
+        ch.insert(keys_[i], values_[i]);
+    }
+    for (size_t i = 0; i < 30; ++i){
+        std::string_view key = keys_[i];
+        ASSERT_TRUE(ch.contains(key));
+        EXPECT_EQ(ch.lookup(key), values_[i]);
+    }
+    EXPECT_FALSE(ch.contains(std::string_view("missing")));
+    EXPECT_TRUE(ch.contains("a"));
+    ch.erase(std::string_view("a"));
+    EXPECT_FALSE(ch.contains("a"));
+    EXPECT_EQ(ch.size(), 29);
+    EXPECT_TRUE(ch.try_emplace(std::string_view("a"), 1));
+    EXPECT_EQ(ch.lookup("a"), 1);
+}
+
+TEST_F(CuckooTest, cuckooMapSnapshot){
+    std::string path = (std::filesystem::temp_directory_path() / "cuckoo-test-snapshot.bin").string();
+    // Saved in the middle of an incremental rehash, so the old tables are saved too
+    CuckooHashMap<int, int> ch(0.4, 0.2, 0, 4);
+    for (int i = 0; i < 4000; ++i){
+        ch.insert(i, -i);
+    }
+    ch.save(path);
+
+    {
+        CuckooHashMap<int, int> opened = CuckooHashMap<int, int>::open(path);
+        EXPECT_EQ(opened.size(), 4000);
+        size_t count = 0;
+        for (auto [key, value] : opened){
+            EXPECT_EQ(value, -key);
+            ++count;
+        }
+        EXPECT_EQ(count, 4000);
+
+        // Changes stay in memory, even after the tables are rehashed out of the file
+        for (int i = 4000; i < 16000; ++i){
+            opened.insert(i, -i);
+        }
+        for (int i = 0; i < 1000; ++i){
+            opened.erase(i);
+        }
+        EXPECT_EQ(opened.size(), 15000);
+        EXPECT_FALSE(opened.contains(0));
+        EXPECT_EQ(opened.lookup(15999), -15999);
+    }
+
+    CuckooHashMap<int, int> reopened = CuckooHashMap<int, int>::open(path);
+    EXPECT_EQ(reopened.size(), 4000);
+    for (int i = 0; i < 4000; ++i){
+        ASSERT_TRUE(reopened.contains(i));
+        EXPECT_EQ(reopened.lookup(i), -i);
+    }
+    EXPECT_FALSE(reopened.contains(4000));
+
+    EXPECT_THROW((CuckooHashMap<int, double>::open(path)), std::invalid_argument);
+    std::ofstream(path, std::ios::trunc) << "not a snapshot";
+    EXPECT_THROW((CuckooHashMap<int, int>::open(path)), std::invalid_argument);
+    std::filesystem::remove(path);
+    EXPECT_THROW((CuckooHashMap<int, int>::open(path)), std::runtime_error);
+}
+
+TEST_F(CuckooTest, cuckooMapCorruptSnapshot){
+    std::string path = (std::filesystem::temp_directory_path() / "cuckoo-test-corrupt.bin").string();
+    CuckooHashMap<int, int> ch(0.4, 0.2, 0, 4);
+    for (int i = 0; i < 4000; ++i){
+        ch.insert(i, -i);
+    }
+    ch.save(path);
+    std::string saved;
+    {
+        std::ifstream in(path, std::ios::binary);
+        saved.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    // Writes the saved file with one header field replaced, offsets follow SnapshotHeader
+    auto corrupt = [&](size_t offset, uint64_t value){
+        std::string bytes = saved;
+        std::memcpy(bytes.data() + offset, &value, sizeof(value));
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+    };
+    constexpr size_t NUM_BUCKETS = 32, SIZE = 40, STASH_SIZE = 48, OLD_NUM_BUCKETS = 56, MIGRATED = 64;
+    uint64_t numBuckets, oldNumBuckets;
+    std::memcpy(&numBuckets, saved.data() + NUM_BUCKETS, sizeof(numBuckets));
+    std::memcpy(&oldNumBuckets, saved.data() + OLD_NUM_BUCKETS, sizeof(oldNumBuckets));
+    ASSERT_GT(oldNumBuckets, 0); // Saved during an incremental rehash
+
+    corrupt(NUM_BUCKETS, 0);
+    EXPECT_THROW((CuckooHashMap<int, int>::open(path)), std::invalid_argument);
+    corrupt(STASH_SIZE, 1000);
+    EXPECT_THROW((CuckooHashMap<int, int>::open(path)), std::invalid_argument);
+    corrupt(MIGRATED, 2 * oldNumBuckets + 1);
+    EXPECT_THROW((CuckooHashMap<int, int>::open(path)), std::invalid_argument);
+    corrupt(SIZE, uint64_t(-1));
+    EXPECT_THROW((CuckooHashMap<int, int>::open(path)), std::invalid_argument);
+    // 2 * numBuckets * sizeof(Item) wraps around to the true size, for any Item size that is a multiple of 4
+    corrupt(NUM_BUCKETS, numBuckets + (uint64_t(1) << 62));
+    EXPECT_THROW((CuckooHashMap<int, int>::open(path)), std::invalid_argument);
+
+    // A copy owns its tables, so it outlives the mapped original
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << saved;
+    CuckooHashMap<int, int> *opened = new CuckooHashMap<int, int>(CuckooHashMap<int, int>::open(path));
+    CuckooHashMap<int, int> copy(*opened);
+    delete opened;
+    EXPECT_EQ(copy.size(), 4000);
+    for (int i = 0; i < 4000; ++i){
+        ASSERT_TRUE(copy.contains(i));
+        EXPECT_EQ(copy.lookup(i), -i);
+    }
+    copy.insert(4000, -4000);
+    EXPECT_EQ(copy.lookup(4000), -4000);
+    std::filesystem::remove(path);
+}
+
 TEST_F(CuckooTest, cuckooSet){
  // CUCKOO SET
  CuckooHashSet<string> cs = CuckooHashSet<string>(0.3, 0.2);
@@ -55,5 +296,323 @@ TEST_F(CuckooTest, cuckooSet){
  for (size_t i = 10; i < 15; ++i){
      cs.insert(keys_[i]);
  }
+ EXPECT_EQ(cs.size(), 5);
+
+}
+
+TEST_F(CuckooTest, cuckooSetIteration){
+    // Groups of many int slots share one mask word, strings are one per group
+    CuckooHashSet<int> ints;
+    CuckooHashSet<string> strings;
+    for (int i = 0; i < 10000; ++i){
+        ints.insert(i);
+        strings.insert(std::to_string(i));
+    }
+    for (int i = 0; i < 10000; i += 3){
+        ints.erase(i);
+        strings.erase(std::to_string(i));
+    }
+    EXPECT_EQ(ints.size(), 6666);
+    EXPECT_EQ(strings.size(), 6666);
+
+    std::vector<bool> seen(10000, false);
+    for (int key : ints){
+        ASSERT_TRUE(key % 3 != 0);
+        EXPECT_FALSE(seen[key]);
+        seen[key] = true;
+    }
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), true), 6666);
+    size_t count = 0;
+    for (const string &key : strings){
+        EXPECT_NE(std::stoi(key) % 3, 0);
+        ++count;
+    }
+    EXPECT_EQ(count, 6666);
+
+    ints.clear();
+    EXPECT_EQ(ints.begin(), ints.end());
+}
+// Tags and keys of a bucket share one cache line, values are stored apart
+static_assert(BucketCuckooHashMap<int, int, 4>::ONE_LINE_BUCKETS);
+static_assert(BucketCuckooHashMap<int, int, 8>::ONE_LINE_BUCKETS);
+static_assert(BucketCuckooHashMap<uint64_t, std::string, 4>::ONE_LINE_BUCKETS);
+static_assert(!BucketCuckooHashMap<uint64_t, int, 8>::ONE_LINE_BUCKETS);
+
+TEST_F(CuckooTest, bucketMap){
+    BucketCuckooHashMap<string, int> ch = BucketCuckooHashMap<string, int>(0.3, 0.2);
+    for (size_t i = 0; i < 30; ++i){
+        ch.insert(keys_[i], values_[i]);
+    }
+    EXPECT_EQ(ch.size(), 30);
+    for (size_t i = 0; i < 20; ++i)
+    {
+        EXPECT_EQ(values_[i], ch[keys_[i]]);
+        ch.erase(keys_[i]);
+        EXPECT_FALSE(ch.contains(keys_[i]));
+    }
+    EXPECT_EQ(ch.size(), 10);
+    for (size_t i = 20; i < 30; ++i){
+        EXPECT_EQ(values_[i], ch.lookup(keys_[i]));
+    }
 
-}
\ No newline at end of file
+    ch.insert("string", 155);
+    ch["string"] = 144;
+    EXPECT_EQ(ch["string"], 144);
+
+    size_t count = 0;
+    for (auto [key, value] : ch){
+        EXPECT_EQ(ch.lookup(key), value);
+        ++count;
+    }
+    EXPECT_EQ(count, ch.size());
+
+    ch.clear();
+    EXPECT_TRUE(ch.empty());
+}
+
+TEST_F(CuckooTest, bucketMapLoadFactor){
+    // 8 slot buckets should fill most of the table before having to resize
+    BucketCuckooHashMap<int, int, 8> ch;
+    double maxLoad = 0;
+    for (int i = 0; i < 100000; ++i){
+        ch.insert(i, -i);
+        maxLoad = std::max(maxLoad, ch.loadFactor());
+    }
+    EXPECT_EQ(ch.size(), 100000);
+    EXPECT_GT(maxLoad, 0.9);
+    for (int i = 0; i < 100000; ++i){
+        ASSERT_TRUE(ch.contains(i));
+        EXPECT_EQ(ch.lookup(i), -i);
+    }
+    EXPECT_FALSE(ch.contains(100000));
+}
+
+TEST_F(CuckooTest, bucketMapNegativeLookups){
+    // Tags of absent keys can collide with stored tags, keys must still be compared
+    BucketCuckooHashMap<string, size_t> ch;
+    for (size_t i = 0; i < 20000; ++i){
+        ch.insert("present" + std::to_string(i), i);
+    }
+    for (size_t i = 0; i < 20000; ++i){
+        EXPECT_FALSE(ch.contains("absent" + std::to_string(i)));
+        ASSERT_TRUE(ch.contains("present" + std::to_string(i)));
+        EXPECT_EQ(ch.lookup("present" + std::to_string(i)), i);
+    }
+    for (size_t i = 0; i < 20000; i += 2){
+        ch.erase("present" + std::to_string(i));
+    }
+    for (size_t i = 0; i < 20000; ++i){
+        EXPECT_EQ(ch.contains("present" + std::to_string(i)), i % 2 == 1);
+    }
+    EXPECT_EQ(ch.size(), 10000);
+}
+
+TEST_F(CuckooTest, cuckooFilter){
+    CuckooFilter<int> cf(20000, 0.01);
+    EXPECT_EQ(cf.fingerprintBits(), 10);
+    for (int i = 0; i < 20000; ++i){
+        ASSERT_TRUE(cf.insert(i));
+    }
+    EXPECT_EQ(cf.size(), 20000);
+    // No false negatives, and false positives close to the bound
+    size_t falsePositives = 0;
+    for (int i = 0; i < 20000; ++i){
+        ASSERT_TRUE(cf.contains(i));
+        falsePositives += cf.contains(-1 - i);
+    }
+    EXPECT_LE(double(falsePositives) / 20000, 2 * cf.falsePositiveRate());
+
+    for (int i = 0; i < 20000; i += 2){
+        EXPECT_TRUE(cf.erase(i));
+    }
+    EXPECT_EQ(cf.size(), 10000);
+    for (int i = 1; i < 20000; i += 2){
+        ASSERT_TRUE(cf.contains(i));
+    }
+
+    // Duplicates are stored twice
+    CuckooFilter<std::string> strings;
+    strings.insert("a");
+    strings.insert("a");
+    EXPECT_TRUE(strings.erase("a"));
+    EXPECT_TRUE(strings.contains("a"));
+    EXPECT_TRUE(strings.erase("a"));
+    EXPECT_FALSE(strings.contains("a"));
+    EXPECT_TRUE(strings.empty());
+
+    EXPECT_THROW(CuckooFilter<int>::withFingerprintBits(100, 33), std::invalid_argument);
+    EXPECT_THROW(CuckooFilter<int>(100, 1.5), std::invalid_argument);
+}
+
+TEST_F(CuckooTest, cuckooFilterFull){
+    // Small fingerprints fill up the table with few keys, every insert that succeeded must still be found
+    CuckooFilter<int> cf = CuckooFilter<int>::withFingerprintBits(1000, 5);
+    std::vector<int> keys(2 * cf.slots());
+    std::iota(keys.begin(), keys.end(), 0);
+    size_t inserted = cf.insertBatch(keys);
+    EXPECT_LT(inserted, keys.size());
+    EXPECT_GT(cf.loadFactor(), 0.9);
+    EXPECT_EQ(cf.size(), inserted);
+    EXPECT_FALSE(cf.insert(-1));
+    for (size_t i = 0; i < inserted; ++i){
+        ASSERT_TRUE(cf.contains(keys[i]));
+    }
+    // Erasing makes room again
+    for (size_t i = 0; i < 100; ++i){
+        ASSERT_TRUE(cf.erase(keys[i]));
+    }
+    EXPECT_TRUE(cf.insert(-1));
+    for (size_t i = 100; i < inserted; ++i){
+        ASSERT_TRUE(cf.contains(keys[i]));
+    }
+    EXPECT_TRUE(cf.contains(-1));
+}
+
+TEST_F(CuckooTest, batchLookup){
+    CuckooHashMap<string, int> map;
+    CuckooHashSet<string> set;
+    BucketCuckooHashMap<string, int> bucketMap;
+    for (size_t i = 0; i < 30; i += 2){
+        map.insert(keys_[i], values_[i]);
+        set.insert(keys_[i]);
+        bucketMap.insert(keys_[i], values_[i]);
+    }
+
+    // Every other key is in the tables. 30 keys is more than one batch
+    std::array<bool, 30> mapFound, setFound, bucketFound;
+    std::array<int*, 30> mapValues, bucketValues;
+    map.containsBatch(keys_, mapFound);
+    map.lookupBatch(keys_, mapValues);
+    set.containsBatch(keys_, setFound);
+    bucketMap.containsBatch(keys_, bucketFound);
+    bucketMap.lookupBatch(keys_, bucketValues);
+    for (size_t i = 0; i < 30; ++i){
+        bool present = i % 2 == 0;
+        EXPECT_EQ(mapFound[i], present);
+        EXPECT_EQ(setFound[i], present);
+        EXPECT_EQ(bucketFound[i], present);
+        if (present){
+            ASSERT_NE(mapValues[i], nullptr);
+            ASSERT_NE(bucketValues[i], nullptr);
+            EXPECT_EQ(*mapValues[i], values_[i]);
+            EXPECT_EQ(*bucketValues[i], values_[i]);
+        } else {
+            EXPECT_EQ(mapValues[i], nullptr);
+            EXPECT_EQ(bucketValues[i], nullptr);
+        }
+    }
+
+    std::array<bool, 10> tooSmall;
+    EXPECT_THROW(map.containsBatch(keys_, tooSmall), std::invalid_argument);
+}
+
+TEST_F(CuckooTest, concurrentMap){
+    ConcurrentCuckooHashMap<string, int> ch(4, 5);
+    for (size_t i = 0; i < 30; ++i){
+        ch.insert(keys_[i], values_[i]);
+    }
+    EXPECT_EQ(ch.size(), 30);
+    for (size_t i = 0; i < 20; ++i)
+    {
+        EXPECT_EQ(values_[i], ch.lookup(keys_[i]));
+        ch.erase(keys_[i]);
+        EXPECT_FALSE(ch.contains(keys_[i]));
+    }
+    EXPECT_EQ(ch.size(), 10);
+    EXPECT_THROW(ch.lookup(keys_[0]), std::out_of_range);
+    int value = 0;
+    EXPECT_TRUE(ch.find(keys_[25], value));
+    EXPECT_EQ(value, values_[25]);
+    ch.clear();
+    EXPECT_TRUE(ch.empty());
+}
+
+template <typename key_t>
+void concurrentInsertAndRead(std::function<key_t(int)> makeKey){
+    // Writers insert disjoint ranges while readers look up keys that are already in the map
+    const int numWriters = 4;
+    const int perWriter = 20000;
+    ConcurrentCuckooHashMap<key_t, int> ch(16, 5);
+    for (int i = 0; i < 1000; ++i){
+        ch.insert(makeKey(-1 - i), i);
+    }
+    std::atomic<bool> done{false};
+    std::atomic<size_t> readErrors{0};
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < numWriters; ++w){
+        threads.emplace_back([&, w](){
+            for (int i = w * perWriter; i < (w + 1) * perWriter; ++i){
+                ch.insert(makeKey(i), i);
+            }
+        });
+    }
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r){
+        readers.emplace_back([&](){
+            while (!done){
+                for (int i = 0; i < 1000; ++i){
+                    int value = -1;
+                    if (!ch.find(makeKey(-1 - i), value) or value != i){
+                        ++readErrors;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread &t : threads){
+        t.join();
+    }
+    done = true;
+    for (std::thread &t : readers){
+        t.join();
+    }
+
+    EXPECT_EQ(readErrors, 0);
+    EXPECT_EQ(ch.size(), numWriters * perWriter + 1000);
+    for (int i = 0; i < numWriters * perWriter; ++i){
+        ASSERT_TRUE(ch.contains(makeKey(i)));
+        EXPECT_EQ(ch.lookup(makeKey(i)), i);
+    }
+}
+
+TEST_F(CuckooTest, concurrentMapThreadsOptimistic){
+    concurrentInsertAndRead<int>([](int i){ return i; });
+}
+
+TEST_F(CuckooTest, concurrentMapThreadsLocked){
+    concurrentInsertAndRead<string>([](int i){ return std::to_string(i); });
+}
+
+TEST_F(CuckooTest, concurrentMapClearWhileReading){
+    // Every clear and grow retires a table while readers may still be probing it
+    ConcurrentCuckooHashMap<int, int> ch(16, 5);
+    std::atomic<bool> done{false};
+    std::atomic<size_t> readErrors{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r){
+        readers.emplace_back([&](){
+            while (!done){
+                for (int i = 0; i < 5000; i += 7){
+                    int value = -1;
+                    if (ch.find(i, value) and value != -i){
+                        ++readErrors;
+                    }
+                }
+            }
+        });
+    }
+    for (int cycle = 0; cycle < 50; ++cycle){
+        for (int i = 0; i < 5000; ++i){
+            ch.insert(i, -i);
+        }
+        EXPECT_EQ(ch.size(), 5000);
+        ch.clear();
+        EXPECT_TRUE(ch.empty());
+    }
+    done = true;
+    for (std::thread &t : readers){
+        t.join();
+    }
+    EXPECT_EQ(readErrors, 0);
+}
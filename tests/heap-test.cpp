@@ -5,12 +5,16 @@
 #include <iostream>
 #include <algorithm>
 #include <random>
+#include <numeric>
+#include <thread>
 
 // Heaps
 #include "heap/d-ary.hpp"
 #include "heap/binomial.hpp"
 #include "heap/fibonacci.hpp"
 #include "heap/pairing.hpp"
+#include "heap/radix.hpp"
+#include "heap/multi-queue.hpp"
 
 #include "interfaces.hpp"
 
@@ -20,6 +24,7 @@ class NameGenerator {
     static std::string GetName(int) {
        if constexpr (std::is_same_v<T, BinaryMinHeap<int>>) return "Binary Heap";
        if constexpr (std::is_same_v<T, DAryHeap<int,int,4>>) return "D-Ary Heap (d=4)";
+       if constexpr (std::is_same_v<T, DAryHeap<int,int,8>>) return "D-Ary Heap (d=8)";
        if constexpr (std::is_same_v<T, BinomialHeap<int, int>>) return "Binomial Heap";
        if constexpr (std::is_same_v<T, FibonacciHeap<int, int>>) return "Fibonacci Heap";
        if constexpr (std::is_same_v<T, PairingHeap<int, int>>) return "Pairing Heap";
@@ -53,6 +58,7 @@ using testing::Types;
 
 typedef Types<BinaryMinHeap<int>,
               DAryHeap<int, int, 4>, 
+              DAryHeap<int, int, 8>,
               BinomialHeap<int, int>,
               FibonacciHeap<int, int>,
               PairingHeap<int, int>> Implementations;
@@ -193,3 +199,373 @@ TYPED_TEST(HeapTest, changeKey2){
     this->heap_.changeKey(10, 4);
     
 }
+
+TYPED_TEST(HeapTest, pushRange){
+    static_assert(BulkHeap<TypeParam>);
+    std::vector<std::pair<int, int>> items;
+    for (int i = 0; i < 300; ++i){
+        items.push_back({i - 100, i - 100});
+    }
+    std::mt19937 rng(11);
+    std::ranges::shuffle(items, rng);
+    this->heap_.push(500, 500);
+    this->heap_.push_range(items.begin(), items.begin() + 150);
+    ASSERT_EQ(this->heap_.top(), items[std::ranges::min_element(items.begin(), items.begin() + 150) - items.begin()].first);
+    // Fewer items than the heap holds, pushed one by one in DAryHeap
+    this->heap_.push_range(items.begin() + 150, items.begin() + 200);
+    this->heap_.push_range(items.begin() + 200, items.end());
+    this->heap_.push_range(items.end(), items.end());
+    ASSERT_EQ(this->heap_.size(), 301);
+    ASSERT_EQ(this->heap_.top(), -100);
+
+    // The items can still be found
+    this->heap_.changeKey(500, -500);
+    ASSERT_EQ(this->heap_.top(), 500);
+    this->heap_.pop();
+    this->heap_.changeKey(150, -150);
+    ASSERT_EQ(this->heap_.top(), 150);
+    this->heap_.pop();
+    ASSERT_TRUE(this->checkHeap());
+}
+
+TYPED_TEST(HeapTest, merge){
+    if constexpr (MeldableHeap<TypeParam>) {
+        TypeParam other;
+        // Merging into an empty heap and from an empty heap
+        this->heap_.merge(std::move(other));
+        ASSERT_TRUE(this->heap_.empty());
+        for (int x : {5, -3, 8}){
+            other.push(x, x);
+        }
+        this->heap_.merge(std::move(other));
+        ASSERT_EQ(this->heap_.size(), 3);
+        ASSERT_TRUE(other.empty());
+        ASSERT_EQ(this->heap_.top(), -3);
+
+        // Shards with distinct items, the larger one merged into the smaller
+        std::vector<TypeParam> shards(4);
+        for (int x = 10; x < 410; ++x){
+            shards[x % 4 == 0 ? 0 : 1].push(x, x);
+        }
+        this->heap_.pop();
+        this->heap_.merge(std::move(shards[0]));
+        this->heap_.merge(std::move(shards[1]));
+        this->heap_.merge(std::move(this->heap_));
+        ASSERT_EQ(this->heap_.size(), 402);
+        ASSERT_EQ(this->heap_.top(), 5);
+
+        // Items from the other heaps can still be found, and other is usable again
+        this->heap_.changeKey(409, -10);
+        ASSERT_EQ(this->heap_.top(), 409);
+        other.push(1, 1);
+        other.changeKey(1, -20);
+        this->heap_.merge(std::move(other));
+        ASSERT_EQ(this->heap_.size(), 403);
+        std::vector<int> order;
+        while (!this->heap_.empty()){
+            order.push_back(this->heap_.top());
+            this->heap_.pop();
+        }
+        std::vector<int> expected{1, 409, 5, 8};
+        for (int x = 10; x < 409; ++x){
+            expected.push_back(x);
+        }
+        ASSERT_EQ(order, expected);
+    } else {
+        GTEST_SKIP() << "Heap has no merge";
+    }
+}
+
+TEST(DAryHeapTest, heapifyConstructor){
+    std::vector<std::pair<int, int>> items;
+    for (int i = 0; i < 1000; ++i){
+        items.push_back({i, 1000 - i});
+    }
+    DAryHeap<int, int, 4> heap(items.begin(), items.end());
+    ASSERT_EQ(heap.size(), 1000);
+    heap.changeKey(0, -1);
+    ASSERT_EQ(heap.top(), 0);
+    heap.pop();
+    for (int expected = 999; expected > 0; --expected){
+        ASSERT_EQ(heap.top(), expected);
+        heap.pop();
+    }
+    ASSERT_TRUE(heap.empty());
+}
+
+// IndexedDAryHeap only takes non-negative items, so it is tested on its own
+TEST(IndexedDAryHeapTest, dijkstraOrder){
+    IndexedDAryHeap<size_t, int, 4> heap;
+    std::vector<size_t> v(500);
+    std::iota(v.begin(), v.end(), 0);
+    std::mt19937 rng(7);
+    std::ranges::shuffle(v, rng);
+    for (size_t x : v){
+        heap.push(x, int(x) + 1000);
+    }
+    // Lower every odd vertex below every even one
+    for (size_t x = 1; x < 500; x += 2){
+        heap.changeKey(x, int(x));
+    }
+    for (size_t expected = 1; expected < 500; expected += 2){
+        ASSERT_EQ(heap.top(), expected);
+        heap.pop();
+    }
+    for (size_t expected = 0; expected < 500; expected += 2){
+        ASSERT_EQ(heap.top(), expected);
+        heap.pop();
+    }
+    ASSERT_TRUE(heap.empty());
+}
+
+TEST(IndexedDAryHeapTest, missingItems){
+    IndexedDAryHeap<int, int> heap;
+    heap.push(3, 3);
+    heap.push(0, 0);
+    ASSERT_THROW(heap.changeKey(10, -1), std::invalid_argument);
+    ASSERT_THROW(heap.changeKey(-1, -1), std::invalid_argument);
+    ASSERT_THROW(heap.push(-1, 1), std::out_of_range);
+    // Popped items are no longer found
+    heap.pop();
+    ASSERT_THROW(heap.changeKey(0, -1), std::invalid_argument);
+    heap.changeKey(3, -1);
+    ASSERT_EQ(heap.top(), 3);
+    ASSERT_EQ(heap.size(), 1);
+}
+
+// The Fibonacci and Binomial heaps can find their nodes through a DenseIndex too
+template <typename heap_t>
+class IndexedNodeHeapTest : public testing::Test {};
+
+typedef Types<IndexedFibonacciHeap<size_t, int>, IndexedBinomialHeap<size_t, int>> IndexedNodeHeaps;
+TYPED_TEST_SUITE(IndexedNodeHeapTest, IndexedNodeHeaps);
+
+TYPED_TEST(IndexedNodeHeapTest, dijkstraOrderAfterMerge){
+    // Even vertices in one heap, odd vertices in the other
+    TypeParam even, odd;
+    std::vector<size_t> v(500);
+    std::iota(v.begin(), v.end(), 0);
+    std::mt19937 rng(7);
+    std::ranges::shuffle(v, rng);
+    for (size_t x : v){
+        (x % 2 ? odd : even).push(x, int(x) + 1000);
+    }
+    // Build some trees before merging
+    even.pop();
+    odd.pop();
+    even.merge(std::move(odd));
+    ASSERT_TRUE(odd.empty());
+    ASSERT_THROW(even.changeKey(0, -1), std::invalid_argument);
+
+    // Lower every odd vertex below every even one
+    for (size_t x = 3; x < 500; x += 2){
+        even.changeKey(x, int(x));
+    }
+    for (size_t expected = 3; expected < 500; expected += 2){
+        ASSERT_EQ(even.top(), expected);
+        even.pop();
+    }
+    for (size_t expected = 2; expected < 500; expected += 2){
+        ASSERT_EQ(even.top(), expected);
+        even.pop();
+    }
+    ASSERT_TRUE(even.empty());
+}
+
+// RadixHeap needs monotone unsigned priorities, so it is tested on its own
+TEST(RadixHeapTest, matchesBinaryHeap){
+    // Dijkstra like use: pushes and decreases never go below the last popped priority
+    RadixHeap<int, uint32_t> radix;
+    BinaryMinHeap<uint32_t> binary;
+    std::vector<uint32_t> priorities(2000, std::numeric_limits<uint32_t>::max());
+    std::mt19937 rng(11);
+    int next = 0;
+    uint32_t last = 0;
+    for (size_t step = 0; step < 20000; ++step){
+        if (rng() % 3 and next < 2000){
+            priorities[next] = last + rng() % 5000;
+            radix.push(next, priorities[next]);
+            binary.push(next, priorities[next]);
+            ++next;
+        } else if (rng() % 2 and next > 0){
+            int item = int(rng() % next);
+            if (priorities[item] != std::numeric_limits<uint32_t>::max() and priorities[item] > last){
+                priorities[item] = last + (priorities[item] - last) / 2;
+                radix.changeKey(item, priorities[item]);
+                binary.changeKey(item, priorities[item]);
+            }
+        } else if (!radix.empty()){
+            // Items with equal priorities may come out in any order
+            int item = radix.top();
+            ASSERT_EQ(priorities[item], priorities[binary.top()]);
+            last = priorities[item];
+            radix.pop();
+            binary.changeKey(item, 0);
+            binary.pop();
+            priorities[item] = std::numeric_limits<uint32_t>::max();
+        }
+        ASSERT_EQ(radix.size(), binary.size());
+    }
+}
+
+TEST(RadixHeapTest, topMatchesPop){
+    IndexedRadixHeap<size_t, uint16_t> heap;
+    for (size_t x = 0; x < 100; ++x){
+        heap.push(x, uint16_t(1000 + x % 7));
+    }
+    std::vector<size_t> popped;
+    while (!heap.empty()){
+        size_t item = heap.top();
+        heap.pop();
+        popped.push_back(item);
+        ASSERT_EQ(std::ranges::count(popped, item), 1);
+    }
+    ASSERT_EQ(popped.size(), 100);
+    for (size_t i = 1; i < popped.size(); ++i){
+        ASSERT_LE(popped[i - 1] % 7, popped[i] % 7);
+    }
+}
+
+TEST(RadixHeapTest, rejectsNonMonotonePriorities){
+    RadixHeap<int, uint32_t> heap;
+    heap.push(1, 10);
+    heap.push(2, 20);
+    heap.pop();
+    ASSERT_THROW(heap.push(3, 9), std::invalid_argument);
+    ASSERT_THROW(heap.changeKey(2, 9), std::invalid_argument);
+    ASSERT_THROW(heap.changeKey(2, 21), std::invalid_argument);
+    ASSERT_THROW(heap.changeKey(1, 15), std::invalid_argument);
+    heap.changeKey(2, 10);
+    heap.push(3, 10);
+    ASSERT_EQ(heap.size(), 2);
+    heap.pop();
+    heap.pop();
+    ASSERT_THROW(heap.pop(), std::logic_error);
+}
+
+// D = 16 and D = 32 with 4 byte priorities find the min child with SIMD compares
+template <typename heap_t, typename Compare, typename priority_t>
+void checkSorted(std::vector<priority_t> priorities){
+    heap_t heap;
+    for (size_t i = 0; i < priorities.size(); ++i){
+        heap.push(int(i), priorities[i]);
+    }
+    std::vector<priority_t> popped;
+    while (!heap.empty()){
+        popped.push_back(priorities[heap.top()]);
+        heap.pop();
+    }
+    std::ranges::sort(priorities, Compare{});
+    ASSERT_EQ(popped, priorities);
+}
+
+TEST(DAryHeapTest, simdMinChild){
+    std::mt19937 rng(7);
+    std::vector<uint32_t> unsignedPriorities(2000);
+    std::vector<float> floatPriorities(2000);
+    std::vector<int> signedPriorities(2000);
+    for (size_t i = 0; i < 2000; ++i){
+        // Few distinct values so children often tie, and unsigned values above INT_MAX
+        unsignedPriorities[i] = uint32_t(rng() % 50) * 0x05000000u;
+        floatPriorities[i] = float(int(rng() % 100) - 50) / 4;
+        signedPriorities[i] = int(rng() % 100) - 50;
+    }
+    checkSorted<DAryHeap<int, uint32_t, 32>, std::less<uint32_t>>(unsignedPriorities);
+    checkSorted<DAryHeap<int, uint32_t, 16, std::greater<uint32_t>>, std::greater<uint32_t>>(unsignedPriorities);
+    checkSorted<DAryHeap<int, float, 16>, std::less<float>>(floatPriorities);
+    checkSorted<DAryHeap<int, float, 32, std::greater<float>>, std::greater<float>>(floatPriorities);
+    checkSorted<DAryHeap<int, int, 16, std::greater<int>>, std::greater<int>>(signedPriorities);
+    checkSorted<DAryHeap<int, int, 10>, std::less<int>>(signedPriorities);
+}
+
+// MultiQueue pops are relaxed when threads share it, top and pop are exact
+TEST(MultiQueueTest, exactTopAndPop){
+    MultiQueue<int, int> heap(4);
+    static_assert(BasicHeap<MultiQueue<int, int>>);
+    std::vector<int> priorities(1000);
+    std::mt19937 rng(5);
+    for (int i = 0; i < 1000; ++i){
+        priorities[i] = int(rng() % 200);
+        heap.push(i, priorities[i]);
+    }
+    ASSERT_EQ(heap.size(), 1000);
+    std::vector<int> popped;
+    while (!heap.empty()){
+        popped.push_back(priorities[heap.top()]);
+        heap.pop();
+    }
+    ASSERT_TRUE(std::ranges::is_sorted(popped));
+    ASSERT_EQ(popped.size(), 1000);
+    ASSERT_THROW(heap.pop(), std::logic_error);
+    ASSERT_FALSE(heap.tryPop().has_value());
+
+    // Shards keep no index, so an item can be in the queue twice
+    heap.push(7, 3);
+    heap.push(7, 1);
+    ASSERT_EQ(heap.size(), 2);
+    ASSERT_EQ(heap.top(), 7);
+    heap.pop();
+    ASSERT_EQ(heap.top(), 7);
+    heap.pop();
+    ASSERT_TRUE(heap.empty());
+}
+
+TEST(MultiQueueTest, concurrentPushAndTryPop){
+    constexpr size_t THREADS = 4, ITEMS = 20000;
+    MultiQueue<size_t, size_t> heap(THREADS);
+    std::vector<std::vector<size_t>> popped(THREADS);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; ++t){
+        threads.emplace_back([&heap, &popped, t](){
+            // Each thread pushes its own items and pops after every second push
+            for (size_t i = t; i < ITEMS; i += THREADS){
+                heap.push(i, i % 1000);
+                if ((i / THREADS) % 2){
+                    while (true){
+                        std::optional<std::pair<size_t, size_t>> top = heap.tryPop();
+                        if (top){
+                            ASSERT_EQ(top->second, top->first % 1000);
+                            popped[t].push_back(top->first);
+                            break;
+                        }
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads){
+        thread.join();
+    }
+    ASSERT_EQ(heap.size(), ITEMS / 2);
+    std::vector<size_t> all;
+    while (std::optional<std::pair<size_t, size_t>> top = heap.tryPop()){
+        all.push_back(top->first);
+    }
+    ASSERT_TRUE(heap.empty());
+    for (std::vector<size_t> &items : popped){
+        all.insert(all.end(), items.begin(), items.end());
+    }
+    std::ranges::sort(all);
+    std::vector<size_t> expected(ITEMS);
+    std::iota(expected.begin(), expected.end(), 0);
+    ASSERT_EQ(all, expected);
+}
+
+TEST(MultiQueueTest, relaxedPopsStayNearTheMinimum){
+    // One thread, 8 shards: every tryPop should be among the best few items
+    MultiQueue<int, int> heap(4, 2);
+    for (int i = 0; i < 10000; ++i){
+        heap.push(i, i);
+    }
+    std::vector<int> remaining(10000);
+    std::iota(remaining.begin(), remaining.end(), 0);
+    double totalRank = 0;
+    for (int i = 0; i < 5000; ++i){
+        std::optional<std::pair<int, int>> top = heap.tryPop();
+        ASSERT_TRUE(top.has_value());
+        auto it = std::ranges::lower_bound(remaining, top->first);
+        totalRank += it - remaining.begin();
+        remaining.erase(it);
+    }
+    ASSERT_LT(totalRank / 5000, 8 * heap.shards());
+}